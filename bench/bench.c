@@ -0,0 +1,324 @@
+/*!
+ @file bench.c
+ @brief Benchmark of the timeslice schedulers.
+ @details It sweeps the count of tasks from 10 up to the given limit, one million by default,
+ and prints one record per line, either as comma-separated values or as JSON:
+ - bytes_per_task, the size of a task plus its share of the scheduler
+ - join_ns and drop_ns, the cost of joining and dropping a task, including the tick that applies it
+ - tick_ns and exec_ns, the cost of a call of the tick and the exec, when 0, 1 or 100 percent
+   of the tasks are due on each tick
+ - call_ns, the cost of the exec per executed task
+ - misses, the cache misses of a tick and an exec, if the performance counters are accessible
+ A run whose count of executions does not match the count of due tasks is reported on stderr,
+ and the exit status is then 1.
+ Usage: bench [limit] [csv|json]
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 199309L
+#endif /* __linux__ */
+#include "timeslice.h"
+#include "stimeslice.h"
+#include "wtimeslice.h"
+#include "htimeslice.h"
+#include "btimeslice.h"
+#include "ctimeslice.h"
+#include "vtimeslice.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+static size_t calls = 0;
+static int status = 0;
+static int json = 0;
+static int perf = -1;
+static uint64_t overhead = 0;
+
+static void count_(void *argv)
+{
+    ++*(size_t *)argv;
+}
+
+static uint64_t now_(void)
+{
+    struct timespec ts;
+#if defined(__unix__) || defined(__APPLE__)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else /* C11 */
+    timespec_get(&ts, TIME_UTC);
+#endif /* __unix__ */
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+#if defined(__linux__)
+static int perf_open_(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+static void perf_start_(void)
+{
+    if (perf >= 0)
+    {
+        ioctl(perf, PERF_EVENT_IOC_RESET, 0);
+        ioctl(perf, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+static uint64_t perf_stop_(void)
+{
+    uint64_t value = 0;
+    if (perf >= 0)
+    {
+        ioctl(perf, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(perf, &value, sizeof(value)) != sizeof(value))
+        {
+            value = 0;
+        }
+    }
+    return value;
+}
+#else /* !__linux__ */
+static int perf_open_(void) { return -1; }
+static void perf_start_(void) {}
+static uint64_t perf_stop_(void) { return 0; }
+#endif /* __linux__ */
+
+#define BACKEND(name)                                                 \
+    static void name##_init_(void *ctx, size_t slice, size_t timer)   \
+    {                                                                 \
+        name##_cron((name##_s *)ctx, count_, &calls, slice);          \
+        name##_set_timer((name##_s *)ctx, timer);                     \
+    }                                                                 \
+    static void name##_join_(void *ctx) { name##_join((name##_s *)ctx); } \
+    static void name##_drop_(void *ctx) { name##_drop((name##_s *)ctx); }
+BACKEND(timeslice)
+BACKEND(stimeslice)
+BACKEND(wtimeslice)
+BACKEND(htimeslice)
+BACKEND(btimeslice)
+#undef BACKEND
+
+/* the compact tasks are slots of the array, followed by the array of their cold parts */
+static ctimeslice_sched_s csched[1];
+static void ctimeslice_setup_(void *task, size_t count)
+{
+    ctimeslice_sched_init(csched, (ctimeslice_s *)task, (ctimeslice_call_s *)((ctimeslice_s *)task + count), count);
+}
+static void ctimeslice_init_(void *ctx, size_t slice, size_t timer)
+{
+    size_t id = (size_t)((ctimeslice_s *)ctx - csched->task);
+    ctimeslice_cron_r(csched, id, count_, &calls, slice);
+    ctimeslice_set_timer_r(csched, id, timer);
+}
+static void ctimeslice_join_(void *ctx) { ctimeslice_join_r(csched, (size_t)((ctimeslice_s *)ctx - csched->task)); }
+static void ctimeslice_drop_(void *ctx) { ctimeslice_drop_r(csched, (size_t)((ctimeslice_s *)ctx - csched->task)); }
+static void ctimeslice_tick_(void) { ctimeslice_tick_r(csched); }
+static void ctimeslice_exec_(void) { ctimeslice_exec_r(csched); }
+
+/* the table has its own memory, and the slots of the buffer only stand for the indices */
+static vtimeslice_sched_s vsched[1];
+static char *vbase = 0;
+static void *vmemory = 0;
+#define VTIMESLICE_ID(ctx) ((size_t)((char *)(ctx)-vbase) / (sizeof(uint32_t) * 3))
+static void vtimeslice_setup_(void *task, size_t count)
+{
+    free(vmemory);
+    vbase = (char *)task;
+    vmemory = malloc(VTIMESLICE_MEMORY(count));
+    if (!vmemory)
+    {
+        exit(EXIT_FAILURE);
+    }
+    vtimeslice_sched_init(vsched, vmemory, count);
+}
+static void vtimeslice_init_(void *ctx, size_t slice, size_t timer)
+{
+    vtimeslice_cron_r(vsched, VTIMESLICE_ID(ctx), count_, &calls, slice);
+    vtimeslice_set_timer_r(vsched, VTIMESLICE_ID(ctx), timer);
+}
+static void vtimeslice_join_(void *ctx) { vtimeslice_join_r(vsched, VTIMESLICE_ID(ctx)); }
+static void vtimeslice_drop_(void *ctx) { vtimeslice_drop_r(vsched, VTIMESLICE_ID(ctx)); }
+static void vtimeslice_tick_(void) { vtimeslice_tick_r(vsched); }
+static void vtimeslice_exec_(void) { vtimeslice_exec_r(vsched); }
+
+static const struct backend_s
+{
+    const char *name;
+    size_t task;
+    size_t cold;
+    size_t sched;
+    void (*setup)(void *, size_t);
+    void (*init)(void *, size_t, size_t);
+    void (*join)(void *);
+    void (*drop)(void *);
+    void (*tick)(void);
+    void (*exec)(void);
+} backend[] = {
+    {"timeslice", sizeof(timeslice_s), 0, sizeof(timeslice_sched_s), 0, timeslice_init_, timeslice_join_,
+     timeslice_drop_, timeslice_tick, timeslice_exec},
+    {"stimeslice", sizeof(stimeslice_s), 0, sizeof(stimeslice_sched_s), 0, stimeslice_init_, stimeslice_join_,
+     stimeslice_drop_, stimeslice_tick, stimeslice_exec},
+    {"wtimeslice", sizeof(wtimeslice_s), 0, sizeof(list_s) * (WTIMESLICE_LEVEL << WTIMESLICE_BITS), 0,
+     wtimeslice_init_, wtimeslice_join_, wtimeslice_drop_, wtimeslice_tick, wtimeslice_exec},
+    {"htimeslice", sizeof(htimeslice_s), 0, sizeof(void *) * 4, 0, htimeslice_init_, htimeslice_join_,
+     htimeslice_drop_, htimeslice_tick, htimeslice_exec},
+    {"btimeslice", sizeof(btimeslice_s), 0, sizeof(btimeslice_sched_s) + sizeof(btimeslice_bucket_s) * BTIMESLICE_BUCKET,
+     0, btimeslice_init_, btimeslice_join_, btimeslice_drop_, btimeslice_tick, btimeslice_exec},
+    {"ctimeslice", sizeof(ctimeslice_s), sizeof(ctimeslice_call_s), sizeof(ctimeslice_sched_s), ctimeslice_setup_,
+     ctimeslice_init_, ctimeslice_join_, ctimeslice_drop_, ctimeslice_tick_, ctimeslice_exec_},
+    {"vtimeslice", sizeof(uint32_t) * 3, sizeof(vtimeslice_call_s), sizeof(vtimeslice_sched_s), vtimeslice_setup_,
+     vtimeslice_init_, vtimeslice_join_, vtimeslice_drop_, vtimeslice_tick_, vtimeslice_exec_},
+};
+
+static void print_(const char *name, size_t tasks, const char *metric, double value)
+{
+    if (json)
+    {
+        printf("{\"backend\":\"%s\",\"tasks\":%zu,\"metric\":\"%s\",\"value\":%.3f}\n", name, tasks, metric, value);
+    }
+    else
+    {
+        printf("%s,%zu,%s,%.3f\n", name, tasks, metric, value);
+    }
+}
+
+static void bench_(const struct backend_s *ctx, size_t tasks)
+{
+    static const unsigned int due[] = {0, 1, 100};
+    char *task = (char *)malloc((ctx->task + ctx->cold) * tasks);
+    size_t ticks = 10000000 / tasks;
+    char metric[32];
+    uint64_t t;
+    if (!task)
+    {
+        return;
+    }
+    ticks = ticks < 10 ? 10 : ticks > 100000 ? 100000 : ticks;
+    if (ctx->setup)
+    {
+        ctx->setup(task, tasks);
+    }
+    print_(ctx->name, tasks, "bytes_per_task",
+           (double)(ctx->task + ctx->cold) + (double)ctx->sched / (double)tasks);
+
+    for (unsigned int i = 0; i != sizeof(due) / sizeof(*due); ++i)
+    {
+        /* the slices are 1, 100 or beyond the run, and the phases are spread over the slice */
+        size_t slice = due[i] == 100 ? 1 : due[i] == 1 ? 100 : ticks + 2;
+        uint64_t tick = 0, exec = 0, misses;
+        size_t expect;
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            ctx->init(task + ctx->task * n, slice, due[i] ? n % slice + 1 : slice);
+        }
+        t = now_();
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            ctx->join(task + ctx->task * n);
+        }
+        ctx->tick();
+        ctx->exec();
+        if (i == 0)
+        {
+            print_(ctx->name, tasks, "join_ns", (double)(now_() - t) / (double)tasks);
+        }
+        calls = 0;
+        perf_start_();
+        for (size_t n = 0; n != ticks; ++n)
+        {
+            t = now_();
+            ctx->tick();
+            tick += now_() - t;
+            t = now_();
+            ctx->exec();
+            exec += now_() - t;
+        }
+        misses = perf_stop_();
+        /* every task is due on each tick, once in 100 ticks, or never */
+        expect = due[i] == 100 ? tasks * ticks : due[i] == 1 ? tasks * ticks / 100 : 0;
+        if (calls + (due[i] == 1 ? tasks : 0) < expect || calls > expect + (due[i] == 1 ? tasks : 0))
+        {
+            fprintf(stderr, "%s: %zu tasks executed %zu times, %zu were due\n", ctx->name, tasks, calls, expect);
+            status = 1;
+        }
+        tick = tick > overhead * ticks ? tick - overhead * ticks : 0;
+        exec = exec > overhead * ticks ? exec - overhead * ticks : 0;
+        sprintf(metric, "tick_ns_due%u", due[i]);
+        print_(ctx->name, tasks, metric, (double)tick / (double)ticks);
+        sprintf(metric, "exec_ns_due%u", due[i]);
+        print_(ctx->name, tasks, metric, (double)exec / (double)ticks);
+        if (calls)
+        {
+            sprintf(metric, "call_ns_due%u", due[i]);
+            print_(ctx->name, tasks, metric, (double)exec / (double)calls);
+        }
+        if (perf >= 0)
+        {
+            sprintf(metric, "misses_due%u", due[i]);
+            print_(ctx->name, tasks, metric, (double)misses / (double)ticks);
+        }
+        t = now_();
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            ctx->drop(task + ctx->task * n);
+        }
+        ctx->tick();
+        ctx->exec();
+        if (i == 0)
+        {
+            print_(ctx->name, tasks, "drop_ns", (double)(now_() - t) / (double)tasks);
+        }
+    }
+    free(task);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t limit = 1000000;
+    uint64_t t;
+    if (argc > 1)
+    {
+        limit = (size_t)strtoul(argv[1], 0, 0);
+    }
+    if (argc > 2)
+    {
+        json = strcmp(argv[2], "json") == 0;
+    }
+    perf = perf_open_();
+    t = now_();
+    for (unsigned int i = 0; i != 1000; ++i)
+    {
+        now_();
+    }
+    overhead = (now_() - t) / 1000;
+
+    if (!json)
+    {
+        printf("backend,tasks,metric,value\n");
+    }
+    for (unsigned int i = 0; i != sizeof(backend) / sizeof(*backend); ++i)
+    {
+        for (size_t tasks = 10; tasks <= limit; tasks *= 10)
+        {
+            bench_(backend + i, tasks);
+        }
+    }
+    return status;
+}
@@ -0,0 +1,126 @@
+/*!
+ @file bench_cxx.cc
+ @brief Benchmark of the C++ wrapper of timeslice against the raw C callback.
+ @details It sweeps the count of tasks from 10 up to the given limit, one million by default,
+ with all the tasks due on each tick, and prints the cost of the exec per executed task as call_ns,
+ for the tasks of timeslice_cron() with a C callback and for ts::cron with a lambda.
+ A run that does not execute every task on every tick is reported on stderr, and the exit status is then 1.
+ Usage: bench_cxx [limit] [csv|json]
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.hpp"
+
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+
+static size_t calls = 0;
+static int status = 0;
+static int json = 0;
+
+static void count_(void *argv)
+{
+    ++*static_cast<size_t *>(argv);
+}
+
+static uint64_t now_(void)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static void print_(const char *name, size_t tasks, const char *metric, double value)
+{
+    if (json)
+    {
+        printf("{\"backend\":\"%s\",\"tasks\":%zu,\"metric\":\"%s\",\"value\":%.3f}\n", name, tasks, metric, value);
+    }
+    else
+    {
+        printf("%s,%zu,%s,%.3f\n", name, tasks, metric, value);
+    }
+}
+
+/* the ticks run the exec with all the tasks due, and the tick is left out of the time */
+static void run_(const char *name, size_t tasks)
+{
+    size_t ticks = 10000000 / tasks;
+    uint64_t exec = 0, t;
+    ticks = ticks < 10 ? 10 : ticks > 100000 ? 100000 : ticks;
+    timeslice_tick();
+    timeslice_exec();
+    calls = 0;
+    for (size_t n = 0; n != ticks; ++n)
+    {
+        timeslice_tick();
+        t = now_();
+        timeslice_exec();
+        exec += now_() - t;
+    }
+    if (calls != tasks * ticks)
+    {
+        fprintf(stderr, "%s: %zu tasks executed %zu times, %zu were due\n", name, tasks, calls, tasks * ticks);
+        status = 1;
+    }
+    print_(name, tasks, "call_ns", calls ? static_cast<double>(exec) / static_cast<double>(calls) : 0);
+}
+
+static void bench_(size_t tasks)
+{
+    {
+        std::vector<timeslice_s> task(tasks);
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            timeslice_cron(&task[n], count_, &calls, 1);
+            timeslice_join(&task[n]);
+        }
+        run_("timeslice", tasks);
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            timeslice_drop(&task[n]);
+        }
+        timeslice_tick();
+    }
+    {
+        size_t *argv = &calls;
+        auto fn = [argv] { ++*argv; };
+        std::vector<ts::cron<decltype(fn)>> task;
+        task.reserve(tasks);
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            task.emplace_back(1, fn);
+            task.back().join();
+        }
+        run_("timeslice_cxx", tasks);
+        for (size_t n = 0; n != tasks; ++n)
+        {
+            task[n].drop();
+        }
+        timeslice_tick();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t limit = 1000000;
+    if (argc > 1)
+    {
+        limit = static_cast<size_t>(strtoul(argv[1], nullptr, 0));
+    }
+    if (argc > 2)
+    {
+        json = strcmp(argv[2], "json") == 0;
+    }
+    if (!json)
+    {
+        printf("backend,tasks,metric,value\n");
+    }
+    for (size_t tasks = 10; tasks <= limit; tasks *= 10)
+    {
+        bench_(tasks);
+    }
+    return status;
+}
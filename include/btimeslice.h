@@ -0,0 +1,275 @@
+/*!
+ @file btimeslice.h
+ @brief Cooperative timeslice scheduler implementation with tasks grouped by period.
+ @details The cron tasks with the same slice and the same phase share a bucket with a single
+ release tick, so the tick costs the count of distinct buckets plus the tasks that are released.
+ The buckets come from a pool that is given to the scheduler, and the tasks that find no bucket,
+ the once tasks and the tasks with a timer beyond their slice count down on their own.
+ A bucket that fires is queued as a whole, and the exec runs its members. The tick must run
+ in the same context as the exec.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __BTIMESLICE_H__
+#define __BTIMESLICE_H__
+
+#include "list.h"
+
+/*!
+ @brief The count of bits of the hash table of the buckets
+*/
+#if !defined(BTIMESLICE_BITS)
+#define BTIMESLICE_BITS 6
+#endif /* BTIMESLICE_BITS */
+
+/*!
+ @brief The count of buckets of the default scheduler
+*/
+#if !defined(BTIMESLICE_BUCKET)
+#define BTIMESLICE_BUCKET 128
+#endif /* BTIMESLICE_BUCKET */
+
+/*!
+ @brief The count of phases that a staggered join weighs within the slice
+*/
+#if !defined(BTIMESLICE_STAGGER)
+#define BTIMESLICE_STAGGER 32
+#endif /* BTIMESLICE_STAGGER */
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief Instance structure for a bucket of tasks with the same slice and phase
+*/
+typedef struct btimeslice_bucket_s
+{
+    list_s node[1];
+    list_s live[1];
+    list_s task[1];
+    list_s ready[1];
+    size_t count;
+    size_t slice;
+    size_t expire;
+} btimeslice_bucket_s;
+
+/*!
+ @brief Instance structure for timeslice
+*/
+typedef struct btimeslice_s
+{
+    list_s node[1];
+    list_s ready[1];
+    btimeslice_bucket_s *bucket;
+    size_t slice;
+    size_t timer;
+    size_t expire;
+    void (*exec)(void *);
+    void *argv;
+    int stat;
+} btimeslice_s;
+
+/*!
+ @brief Instance structure for timeslice scheduler
+*/
+typedef struct btimeslice_sched_s
+{
+    list_s hash[1 << BTIMESLICE_BITS];
+    list_s live[1];
+    list_s solo[1];
+    list_s idle[1];
+    list_s fired[1];
+    list_s ready[1];
+    list_s *cursor;
+    btimeslice_s *ctx;
+    size_t counter;
+    size_t buckets;
+    size_t now;
+    int stagger;
+} btimeslice_sched_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] bucket points to the pool of buckets
+ @param[in] count The count of buckets in the pool
+*/
+void btimeslice_sched_init(btimeslice_sched_s *sched, btimeslice_bucket_s *bucket, size_t count);
+/*!
+ @brief Get the task that is being executed by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return btimeslice_s * The task of the last execution
+*/
+btimeslice_s *btimeslice_self_r(const btimeslice_sched_s *sched);
+
+/*!
+ @brief Set whether the joins of a timeslice scheduler stagger the phases of the cron tasks
+ @details A cron task that joins with its timer at the full slice starts on the least loaded
+ of BTIMESLICE_STAGGER phases spread over the slice, weighed by the members of the buckets
+ that fire on them. The period of the task is not changed.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] stagger nonzero to stagger the joins
+*/
+void btimeslice_set_stagger_r(btimeslice_sched_s *sched, int stagger);
+/*!
+ @brief Set whether the joins of the timeslice scheduler stagger the phases of the cron tasks
+ @param[in] stagger nonzero to stagger the joins
+*/
+void btimeslice_set_stagger(int stagger);
+
+/*!
+ @brief A function that requires the tick timer to execute
+*/
+void btimeslice_tick(void);
+/*!
+ @brief A function that requires the tick timer to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void btimeslice_tick_r(btimeslice_sched_s *sched);
+/*!
+ @brief A function that requires the cpu to execute
+*/
+void btimeslice_exec(void);
+/*!
+ @brief A function that requires the cpu to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void btimeslice_exec_r(btimeslice_sched_s *sched);
+
+/*!
+ @brief Initialize as a cron task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] slice The length of the time slice
+*/
+void btimeslice_cron(btimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice);
+/*!
+ @brief Initialize as a once task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] delay The length of delayed execution
+*/
+void btimeslice_once(btimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay);
+
+/*!
+ @brief Set the execution function
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+*/
+void btimeslice_set_exec(btimeslice_s *ctx, void (*exec)(void *));
+/*!
+ @brief Set the arguments
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] argv Arguments to the executed function
+*/
+void btimeslice_set_argv(btimeslice_s *ctx, void *argv);
+/*!
+ @brief Set the timer
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] timer Timer value
+*/
+void btimeslice_set_timer(btimeslice_s *ctx, size_t timer);
+/*!
+ @brief Set the timer
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] timer Timer value
+*/
+void btimeslice_set_timer_r(btimeslice_sched_s *sched, btimeslice_s *ctx, size_t timer);
+/*!
+ @brief Set the slice, which moves a joined task to the bucket of the slice
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] slice Slice value
+*/
+void btimeslice_set_slice(btimeslice_s *ctx, size_t slice);
+/*!
+ @brief Set the slice, which moves a joined task to the bucket of the slice
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] slice Slice value
+*/
+void btimeslice_set_slice_r(btimeslice_sched_s *sched, btimeslice_s *ctx, size_t slice);
+
+/*!
+ @brief Join a task to the timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void btimeslice_join(btimeslice_s *ctx);
+/*!
+ @brief Join a task to a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void btimeslice_join_r(btimeslice_sched_s *sched, btimeslice_s *ctx);
+/*!
+ @brief Drop a task from the timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void btimeslice_drop(btimeslice_s *ctx);
+/*!
+ @brief Drop a task from a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void btimeslice_drop_r(btimeslice_sched_s *sched, btimeslice_s *ctx);
+
+/*!
+ @brief Testing whether a task is in a timeslice scheduler
+ @param[in] ctx points to an instance of timeslice
+*/
+int btimeslice_exist(const btimeslice_s *ctx);
+
+/*!
+ @brief Get the timer value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The timer value
+*/
+size_t btimeslice_timer(const btimeslice_s *ctx);
+/*!
+ @brief Get the timer value for a task
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The timer value
+*/
+size_t btimeslice_timer_r(const btimeslice_sched_s *sched, const btimeslice_s *ctx);
+/*!
+ @brief Get the slice value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The slice value
+*/
+size_t btimeslice_slice(const btimeslice_s *ctx);
+/*!
+ @brief Get the count of tasks in the timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t btimeslice_count(void);
+/*!
+ @brief Get the count of tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t btimeslice_count_r(const btimeslice_sched_s *sched);
+/*!
+ @brief Get the count of buckets in use by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of buckets
+*/
+size_t btimeslice_bucket_r(const btimeslice_sched_s *sched);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __BTIMESLICE_H__ */
@@ -0,0 +1,197 @@
+/*!
+ @file ctimeslice.h
+ @brief Cooperative timeslice scheduler implementation with compact tasks in an array.
+ @details The tasks are the slots of an array that is given to the scheduler, and they are
+ referred to by their index. The tick only touches the timer, the slice and the link of
+ a slot, which take 12 bytes with the default 32-bit width or 6 bytes with a 16-bit width,
+ so five or ten tasks share a cache line. The execution functions and their arguments are
+ kept in a separate array. The status bits are packed into the top bits of the link,
+ which limits the count of tasks to 2^28 - 1, or 4095 with a 16-bit width. The slices and
+ timers are limited to the width. The tick scans all the slots, and it must run in the same
+ context as the exec.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __CTIMESLICE_H__
+#define __CTIMESLICE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if !defined CTIMESLICE_WIDTH
+/*!
+ @brief The width in bits of the timer, the slice and the link, which is 16 or 32
+*/
+#define CTIMESLICE_WIDTH 32
+#endif /* CTIMESLICE_WIDTH */
+
+#if CTIMESLICE_WIDTH == 16
+typedef uint16_t ctimeslice_t;
+#elif CTIMESLICE_WIDTH == 32
+typedef uint32_t ctimeslice_t;
+#else /* CTIMESLICE_WIDTH */
+#error "CTIMESLICE_WIDTH must be 16 or 32"
+#endif /* CTIMESLICE_WIDTH */
+
+/*!
+ @brief The largest value of a slice or a timer
+*/
+#define CTIMESLICE_MAX ((ctimeslice_t)~(ctimeslice_t)0)
+
+/*!
+ @brief Instance structure for the hot part of a timeslice task
+*/
+typedef struct ctimeslice_s
+{
+    ctimeslice_t timer;
+    ctimeslice_t slice;
+    ctimeslice_t link;
+} ctimeslice_s;
+
+/*!
+ @brief Instance structure for the cold part of a timeslice task
+*/
+typedef struct ctimeslice_call_s
+{
+    void (*exec)(void *);
+    void *argv;
+} ctimeslice_call_s;
+
+/*!
+ @brief Instance structure for timeslice scheduler
+*/
+typedef struct ctimeslice_sched_s
+{
+    ctimeslice_s *task;
+    ctimeslice_call_s *call;
+    size_t count;
+    size_t counter;
+    size_t head;
+    size_t tail;
+    size_t ctx;
+} ctimeslice_sched_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] task points to an array of the hot part of the tasks
+ @param[in] call points to an array of the cold part of the tasks
+ @param[in] count The count of tasks of both arrays
+*/
+void ctimeslice_sched_init(ctimeslice_sched_s *sched, ctimeslice_s *task, ctimeslice_call_s *call, size_t count);
+/*!
+ @brief Get the task that is being executed by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The index of the task of the last execution
+*/
+size_t ctimeslice_self_r(const ctimeslice_sched_s *sched);
+
+/*!
+ @brief A function that requires the tick timer to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void ctimeslice_tick_r(ctimeslice_sched_s *sched);
+/*!
+ @brief A function that requires the cpu to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void ctimeslice_exec_r(ctimeslice_sched_s *sched);
+
+/*!
+ @brief Initialize as a cron task
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] slice The length of the time slice
+*/
+void ctimeslice_cron_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t slice);
+/*!
+ @brief Initialize as a once task
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] delay The length of delayed execution
+*/
+void ctimeslice_once_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t delay);
+
+/*!
+ @brief Set the execution function
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+*/
+void ctimeslice_set_exec_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *));
+/*!
+ @brief Set the arguments
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] argv Arguments to the executed function
+*/
+void ctimeslice_set_argv_r(ctimeslice_sched_s *sched, size_t id, void *argv);
+/*!
+ @brief Set the timer
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] timer Timer value
+*/
+void ctimeslice_set_timer_r(ctimeslice_sched_s *sched, size_t id, size_t timer);
+/*!
+ @brief Set the slice
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] slice Slice value
+*/
+void ctimeslice_set_slice_r(ctimeslice_sched_s *sched, size_t id, size_t slice);
+
+/*!
+ @brief Join a task to a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+void ctimeslice_join_r(ctimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Drop a task from a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+void ctimeslice_drop_r(ctimeslice_sched_s *sched, size_t id);
+
+/*!
+ @brief Testing whether a task is in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+int ctimeslice_exist_r(const ctimeslice_sched_s *sched, size_t id);
+
+/*!
+ @brief Get the timer value for a task
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @return size_t The timer value
+*/
+size_t ctimeslice_timer_r(const ctimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Get the slice value for a task
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @return size_t The slice value
+*/
+size_t ctimeslice_slice_r(const ctimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Get the count of tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t ctimeslice_count_r(const ctimeslice_sched_s *sched);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CTIMESLICE_H__ */
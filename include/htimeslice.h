@@ -0,0 +1,138 @@
+/*!
+ @file htimeslice.h
+ @brief Cooperative timeslice scheduler implementation based on absolute deadline.
+ @details The tick only increments a counter of the width of size_t, which is a lock-free
+ increment on every target, so it may be called from an interrupt or a signal handler.
+ The counter wraps around, and the deadlines are compared within half of its range. The exec pulls the due tasks from a pairing heap
+ ordered by deadline. All other functions must be called from the context of the exec.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __HTIMESLICE_H__
+#define __HTIMESLICE_H__
+
+#include "pheap.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief Instance structure for timeslice
+*/
+typedef struct htimeslice_s
+{
+    pheap_s node[1];
+    size_t due;
+    size_t slice;
+    size_t timer;
+    void (*exec)(void *);
+    void *argv;
+    int stat;
+} htimeslice_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief A function that requires the tick timer to execute
+*/
+void htimeslice_tick(void);
+/*!
+ @brief A function that requires the cpu to execute
+*/
+void htimeslice_exec(void);
+
+/*!
+ @brief Initialize as a cron task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] slice The length of the time slice
+*/
+void htimeslice_cron(htimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice);
+/*!
+ @brief Initialize as a once task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] delay The length of delayed execution
+*/
+void htimeslice_once(htimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay);
+
+/*!
+ @brief Set the execution function
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+*/
+void htimeslice_set_exec(htimeslice_s *ctx, void (*exec)(void *));
+/*!
+ @brief Set the arguments
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] argv Arguments to the executed function
+*/
+void htimeslice_set_argv(htimeslice_s *ctx, void *argv);
+/*!
+ @brief Set the timer
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] timer Timer value
+*/
+void htimeslice_set_timer(htimeslice_s *ctx, size_t timer);
+/*!
+ @brief Set the slice
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] slice Slice value
+*/
+void htimeslice_set_slice(htimeslice_s *ctx, size_t slice);
+
+/*!
+ @brief Join a task to the deadline heap
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void htimeslice_join(htimeslice_s *ctx);
+/*!
+ @brief Drop a task from the deadline heap
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void htimeslice_drop(htimeslice_s *ctx);
+
+/*!
+ @brief Testing whether a task is in the deadline heap
+ @param[in] ctx points to an instance of timeslice
+*/
+int htimeslice_exist(const htimeslice_s *ctx);
+
+/*!
+ @brief Get the timer value for a task, computed from its deadline
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The remaining ticks
+*/
+size_t htimeslice_timer(const htimeslice_s *ctx);
+/*!
+ @brief Get the slice value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The slice value
+*/
+size_t htimeslice_slice(const htimeslice_s *ctx);
+/*!
+ @brief Get the count of tasks in the deadline heap
+ @return size_t The count of tasks
+*/
+size_t htimeslice_count(void);
+/*!
+ @brief Get the value of the monotonic tick counter
+ @return size_t The tick counter
+*/
+size_t htimeslice_now(void);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __HTIMESLICE_H__ */
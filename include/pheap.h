@@ -0,0 +1,85 @@
+/*!
+ @file pheap.h
+ @brief Intrusive pairing heap implementation.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __PHEAP_H__
+#define __PHEAP_H__
+
+#include <stddef.h>
+
+/*!
+ @brief Instance structure for pairing heap node
+*/
+typedef struct pheap_s
+{
+    struct pheap_s *child; //!< the leftmost child node
+    struct pheap_s *next; //!< the right sibling node
+    struct pheap_s *prev; //!< the left sibling node or the parent node
+} pheap_s;
+
+/*!
+ @brief Get the struct for this entry
+ @param ptr the &pheap_s pointer
+ @param type the type of the struct this is embedded in
+ @param member the name of the pheap_s within the struct
+*/
+#define pheap_entry(ptr, type, member) ((type *)((size_t)(ptr)-offsetof(type, member)))
+
+/*!
+ @brief Compare two nodes of pairing heap
+ @return int less than zero if lhs goes before rhs
+*/
+typedef int (*pheap_cmp_f)(const pheap_s *lhs, const pheap_s *rhs);
+
+/*!
+ @brief initialize for pairing heap node
+ @param[in,out] ctx points to pairing heap node
+*/
+static inline void pheap_init(pheap_s *ctx) { ctx->child = ctx->next = ctx->prev = 0; }
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Meld two pairing heaps
+ @param[in] lhs root node of a pairing heap or null
+ @param[in] rhs root node of a pairing heap or null
+ @param[in] cmp function for comparing two nodes
+ @return pheap_s * root node of the melded pairing heap
+*/
+pheap_s *pheap_meld(pheap_s *lhs, pheap_s *rhs, pheap_cmp_f cmp);
+
+/*!
+ @brief Merge the sibling list of a node in two passes
+ @param[in] node the leftmost node of a sibling list or null
+ @param[in] cmp function for comparing two nodes
+ @return pheap_s * root node of the merged pairing heap
+*/
+pheap_s *pheap_pair(pheap_s *node, pheap_cmp_f cmp);
+
+/*!
+ @brief Insert a node to a pairing heap
+ @param[in] root root node of the pairing heap or null
+ @param[in] node a pairing heap node
+ @param[in] cmp function for comparing two nodes
+ @return pheap_s * root node of the pairing heap
+*/
+pheap_s *pheap_add(pheap_s *root, pheap_s *node, pheap_cmp_f cmp);
+
+/*!
+ @brief Delete a node from a pairing heap
+ @param[in] root root node of the pairing heap
+ @param[in] node a pairing heap node
+ @param[in] cmp function for comparing two nodes
+ @return pheap_s * root node of the pairing heap
+*/
+pheap_s *pheap_del(pheap_s *root, pheap_s *node, pheap_cmp_f cmp);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __PHEAP_H__ */
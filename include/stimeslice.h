@@ -1,6 +1,9 @@
 /*!
  @file stimeslice.h
  @brief Cooperative timeslice scheduler implementation.
+ @details The functions without a scheduler argument work on a default instance, and a null task
+ refers to the task whose function is executing on the calling thread, whichever instance
+ executes it.
  @copyright Copyright (C) 2020 tqfx, All rights reserved.
 */
 
@@ -8,6 +11,12 @@
 #define __STIMESLICE_H__
 
 #include "slist.h"
+#if defined(TIMESLICE_PROFILE)
+#include "timeslice_prof.h"
+#endif /* TIMESLICE_PROFILE */
+#if defined(TIMESLICE_HIST)
+#include "timeslice_hist.h"
+#endif /* TIMESLICE_HIST */
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -20,13 +29,34 @@
 typedef struct stimeslice_s
 {
     slist_u node[1];
+    slist_u ready[1];
     size_t slice;
     size_t timer;
     void (*exec)(void *);
     void *argv;
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    uint64_t release;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    timeslice_prof_s prof[1];
+#endif /* TIMESLICE_PROFILE */
     int stat;
 } stimeslice_s;
 
+/*!
+ @brief Instance structure for timeslice scheduler
+*/
+typedef struct stimeslice_sched_s
+{
+    slist_s running[1];
+    slist_s ready[1];
+    stimeslice_s *ctx;
+#if defined(TIMESLICE_HIST)
+    timeslice_hist_s *hist;
+#endif /* TIMESLICE_HIST */
+    size_t counter;
+} stimeslice_sched_s;
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic pop
 #endif /* __GNUC__ || __clang__ */
@@ -35,14 +65,36 @@ typedef struct stimeslice_s
 extern "C" {
 #endif /* __cplusplus */
 
+/*!
+ @brief Initialize a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void stimeslice_sched_init(stimeslice_sched_s *sched);
+/*!
+ @brief Get the task that is being executed by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return stimeslice_s * The task of the last execution
+*/
+stimeslice_s *stimeslice_self_r(const stimeslice_sched_s *sched);
+
 /*!
  @brief A function that requires the tick timer to execute
 */
 void stimeslice_tick(void);
+/*!
+ @brief A function that requires the tick timer to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void stimeslice_tick_r(stimeslice_sched_s *sched);
 /*!
  @brief A function that requires the cpu to execute
 */
 void stimeslice_exec(void);
+/*!
+ @brief A function that requires the cpu to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void stimeslice_exec_r(stimeslice_sched_s *sched);
 
 /*!
  @brief Initialize as a cron task
@@ -91,11 +143,23 @@ void stimeslice_set_slice(stimeslice_s *ctx, size_t slice);
  @param[in,out] ctx points to an instance of timeslice
 */
 void stimeslice_join(stimeslice_s *ctx);
+/*!
+ @brief Join a task to a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void stimeslice_join_r(stimeslice_sched_s *sched, stimeslice_s *ctx);
 /*!
  @brief Drop a task from the time slice list
  @param[in,out] ctx points to an instance of timeslice
 */
 void stimeslice_drop(stimeslice_s *ctx);
+/*!
+ @brief Drop a task from a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void stimeslice_drop_r(stimeslice_sched_s *sched, stimeslice_s *ctx);
 
 /*!
  @brief Testing whether a task is in the time slice list
@@ -120,6 +184,56 @@ size_t stimeslice_slice(const stimeslice_s *ctx);
  @return size_t The count of tasks
 */
 size_t stimeslice_count(void);
+/*!
+ @brief Get the count of tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t stimeslice_count_r(const stimeslice_sched_s *sched);
+
+#if defined(TIMESLICE_HIST)
+/*!
+ @brief Attach a latency histogram to a timeslice scheduler
+ @details The scheduler adds the latency in nanoseconds from the moment that a task became due
+ to the start of its execution.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] hist points to an instance of latency histogram or null to detach
+*/
+void stimeslice_hist_attach_r(stimeslice_sched_s *sched, timeslice_hist_s *hist);
+/*!
+ @brief Attach a latency histogram to the default timeslice scheduler
+ @param[in] hist points to an instance of latency histogram or null to detach
+*/
+void stimeslice_hist_attach(timeslice_hist_s *hist);
+#endif /* TIMESLICE_HIST */
+
+#if defined(TIMESLICE_PROFILE)
+/*!
+ @brief Get the execution profile of a task
+ @param[in] ctx points to an instance of timeslice
+ @param[out] prof points to a copy of the execution profile
+*/
+void stimeslice_prof(const stimeslice_s *ctx, timeslice_prof_s *prof);
+/*!
+ @brief Reset the execution profile of a task
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void stimeslice_prof_reset(stimeslice_s *ctx);
+/*!
+ @brief Visit the execution profiles of the tasks in the time slice list
+ @param[in] each A function that is called with a task, a copy of its profile and argv
+ @param[in] argv Arguments to the visiting function
+*/
+void stimeslice_prof_each(void (*each)(const stimeslice_s *, const timeslice_prof_s *, void *), void *argv);
+/*!
+ @brief Visit the execution profiles of the tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] each A function that is called with a task, a copy of its profile and argv
+ @param[in] argv Arguments to the visiting function
+*/
+void stimeslice_prof_each_r(const stimeslice_sched_s *sched,
+                            void (*each)(const stimeslice_s *, const timeslice_prof_s *, void *), void *argv);
+#endif /* TIMESLICE_PROFILE */
 
 #if defined(__cplusplus)
 }
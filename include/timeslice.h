@@ -1,6 +1,22 @@
 /*!
  @file timeslice.h
  @brief Cooperative timeslice scheduler implementation.
+ @details If TIMESLICE_ATOMIC is defined, timeslice_tick() and timeslice_exec() may run
+ on two different threads. Tasks are handed from the tick to the exec through a ready queue
+ per priority level, which the tick appends the due tasks of a tick to with one exchange and
+ which only the exec takes from, and the joins and drops are posted to the tick through a
+ lock-free stack, so neither side waits for the other. A drop takes the task out of the side that runs on the
+ calling thread at once, and the side that runs on another thread lets go of it the next
+ time that it walks the task, so the task must stay valid until timeslice_held() returns 0.
+ A side that has not run yet is changed by a drop on any thread, so the drops must not race
+ with the first tick and the first exec.
+ Otherwise the scheduler belongs to a single context, and a drop takes the task out of it at once.
+ The functions without a scheduler argument work on a default instance, and a null task
+ refers to the task whose function is executing on the calling thread, whichever instance
+ executes it.
+ The earliest deadline first policy, and the fields of a task that it needs, are only built
+ if TIMESLICE_EDF is defined, the policies for the missed periods of a task only if
+ TIMESLICE_OVERRUN is defined, and the io tasks only if TIMESLICE_IO is defined.
  @copyright Copyright (C) 2020 tqfx, All rights reserved.
 */
 
@@ -8,6 +24,66 @@
 #define __TIMESLICE_H__
 
 #include "list.h"
+#if defined(TIMESLICE_EDF)
+#include "pheap.h"
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_PROFILE)
+#include "timeslice_prof.h"
+#endif /* TIMESLICE_PROFILE */
+#if defined(TIMESLICE_HIST)
+#include "timeslice_hist.h"
+#endif /* TIMESLICE_HIST */
+#if defined(TIMESLICE_TRACE)
+#include "timeslice_trace.h"
+#endif /* TIMESLICE_TRACE */
+
+#include <stdint.h>
+
+/*!
+ @brief The count of priority levels, the highest level is TIMESLICE_LEVEL - 1
+*/
+#define TIMESLICE_LEVEL 8
+
+#if defined(TIMESLICE_EDF)
+/*!
+ @brief The policies for ordering the due tasks of a timeslice scheduler
+*/
+enum
+{
+    TIMESLICE_POLICY_PRIO, //!< the highest priority level first, FIFO within a level
+    TIMESLICE_POLICY_EDF, //!< the earliest deadline first, the higher level on a tie
+};
+#endif /* TIMESLICE_EDF */
+
+#if defined(TIMESLICE_OVERRUN)
+/*!
+ @brief The policies for the periods that a cron task misses
+*/
+enum
+{
+    TIMESLICE_OVERRUN_SKIP, //!< the missed periods coalesce into one execution
+    TIMESLICE_OVERRUN_CATCHUP, //!< one execution for each missed period, up to a cap
+    TIMESLICE_OVERRUN_SHIFT, //!< one execution, and the next period starts from it
+};
+/*!
+ @brief The largest cap of the executions that catch up with the missed periods
+*/
+#define TIMESLICE_OVERRUN_CAP 255
+#endif /* TIMESLICE_OVERRUN */
+
+#if defined(TIMESLICE_IO)
+/*!
+ @brief The events of the file descriptor of an io task, which have the values of poll
+*/
+enum
+{
+    TIMESLICE_POLLIN = 0x001, //!< there is data to read
+    TIMESLICE_POLLPRI = 0x002, //!< there is urgent data to read
+    TIMESLICE_POLLOUT = 0x004, //!< writing will not block
+    TIMESLICE_POLLERR = 0x008, //!< error condition, always reported
+    TIMESLICE_POLLHUP = 0x010, //!< hang up, always reported
+};
+#endif /* TIMESLICE_IO */
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -20,13 +96,80 @@
 typedef struct timeslice_s
 {
     list_s node[1];
+#if defined(TIMESLICE_EDF)
+    pheap_s heap[1];
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_ATOMIC)
+    struct timeslice_s *link;
+#endif /* TIMESLICE_ATOMIC */
+    struct timeslice_s *next;
     size_t slice;
     size_t timer;
+#if defined(TIMESLICE_ATOMIC)
+    size_t reset;
+#endif /* TIMESLICE_ATOMIC */
+    size_t stamp;
+#if defined(TIMESLICE_EDF)
+    size_t deadline;
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_OVERRUN)
+    size_t missed;
+    size_t overrun;
+#endif /* TIMESLICE_OVERRUN */
     void (*exec)(void *);
     void *argv;
+#if defined(TIMESLICE_IO)
+    int fd;
+    unsigned int events;
+    unsigned int revents;
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    uint64_t release;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    timeslice_prof_s prof[1];
+#endif /* TIMESLICE_PROFILE */
     int stat;
 } timeslice_s;
 
+/*!
+ @brief Instance structure for timeslice scheduler
+*/
+typedef struct timeslice_sched_s
+{
+    list_s running[1];
+    timeslice_s *level[TIMESLICE_LEVEL][2];
+#if defined(TIMESLICE_EDF)
+    pheap_s *deadline;
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_ATOMIC)
+    timeslice_s *pending;
+#endif /* TIMESLICE_ATOMIC */
+    timeslice_s *ctx;
+#if defined(TIMESLICE_TRACE)
+    timeslice_trace_s *trace;
+#endif /* TIMESLICE_TRACE */
+#if defined(TIMESLICE_HIST)
+    timeslice_hist_s *hist;
+#endif /* TIMESLICE_HIST */
+    size_t counter;
+    size_t now;
+    unsigned int bitmap;
+#if defined(TIMESLICE_EDF)
+    int policy;
+#endif /* TIMESLICE_EDF */
+    int wake;
+    int idle;
+#if defined(TIMESLICE_IO)
+    int epoll;
+    int kick;
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_ATOMIC)
+    const void *ticker;
+    const void *runner;
+#endif /* TIMESLICE_ATOMIC */
+} timeslice_sched_s;
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic pop
 #endif /* __GNUC__ || __clang__ */
@@ -35,17 +178,167 @@ typedef struct timeslice_s
 extern "C" {
 #endif /* __cplusplus */
 
+/*!
+ @brief Initialize a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void timeslice_sched_init(timeslice_sched_s *sched);
+#if defined(TIMESLICE_EDF)
+/*!
+ @brief Set the policy for ordering the due tasks
+ @param[in] policy TIMESLICE_POLICY_PRIO or TIMESLICE_POLICY_EDF
+*/
+void timeslice_set_policy(int policy);
+/*!
+ @brief Set the policy for ordering the due tasks of a timeslice scheduler
+ @details The deadline of a cron task is its release tick plus its slice, and the deadline
+ of a once task is its release tick. It must be called from the context of the exec.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] policy TIMESLICE_POLICY_PRIO or TIMESLICE_POLICY_EDF
+*/
+void timeslice_set_policy_r(timeslice_sched_s *sched, int policy);
+#endif /* TIMESLICE_EDF */
+/*!
+ @brief Get the count of ticks that have been applied
+ @return size_t The count of ticks, which wraps around
+*/
+size_t timeslice_now(void);
+/*!
+ @brief Get the count of ticks that a timeslice scheduler has applied
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of ticks, which wraps around
+*/
+size_t timeslice_now_r(const timeslice_sched_s *sched);
+/*!
+ @brief Get the task that is being executed by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return timeslice_s * The task of the last execution
+*/
+timeslice_s *timeslice_self_r(const timeslice_sched_s *sched);
+
 /*!
  @brief A function that requires the tick timer to execute
 */
 void timeslice_tick(void);
+/*!
+ @brief A function that requires the tick timer to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void timeslice_tick_r(timeslice_sched_s *sched);
+/*!
+ @brief Apply many ticks at once, for a host that sleeps until the next expiry
+ @details A cron task that expired one or more times within the elapsed ticks is marked once
+ and keeps its phase. It must be called from the context of the tick.
+ @param[in] elapsed The count of elapsed ticks
+*/
+void timeslice_advance(size_t elapsed);
+/*!
+ @brief Apply many ticks at once, for a host that sleeps until the next expiry
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] elapsed The count of elapsed ticks
+*/
+void timeslice_advance_r(timeslice_sched_s *sched, size_t elapsed);
+/*!
+ @brief Get the ticks until the earliest timer reaches zero
+ @details It must be called from the context of the tick.
+ @return size_t The count of ticks, or 0 if no timer is running
+*/
+size_t timeslice_next_expiry(void);
+/*!
+ @brief Get the ticks until the earliest timer reaches zero
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @return size_t The count of ticks, or 0 if no timer is running
+*/
+size_t timeslice_next_expiry_r(timeslice_sched_s *sched);
 /*!
  @brief A function that requires the cpu to execute
 */
 void timeslice_exec(void);
+/*!
+ @brief A function that requires the cpu to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void timeslice_exec_r(timeslice_sched_s *sched);
+/*!
+ @brief A function that requires the cpu to execute within a time budget
+ @details It executes at least one due task and stops picking tasks once the budget is spent,
+ and the due tasks that are left
+ over stay in the run queue for the next execution, ahead of the tasks that become due later.
+ @param[in] budget The time budget in nanoseconds
+ @return int bool
+  @retval 0 all due tasks have been executed
+  @retval 1 some due tasks are left over
+*/
+int timeslice_exec_budget(uint64_t budget);
+/*!
+ @brief A function that requires the cpu to execute within a time budget
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] budget The time budget in nanoseconds
+ @return int bool
+  @retval 0 all due tasks have been executed
+  @retval 1 some due tasks are left over
+*/
+int timeslice_exec_budget_r(timeslice_sched_s *sched, uint64_t budget);
+/*!
+ @brief A function that requires the cpu to execute, sleeping until a task is due
+ @details On Linux it sleeps on a futex that the tick wakes as soon as it queues a task,
+ elsewhere it returns at once like timeslice_exec(). If TIMESLICE_IO is defined, once an io
+ task has joined, it sleeps on the epoll instance of the scheduler instead, and it notifies
+ the tasks whose file descriptors are ready, also when it does not sleep.
+*/
+void timeslice_exec_wait(void);
+/*!
+ @brief A function that requires the cpu to execute, sleeping until a task is due
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void timeslice_exec_wait_r(timeslice_sched_s *sched);
+/*!
+ @brief Wake the exec that is sleeping in timeslice_exec_wait_r()
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void timeslice_wake_r(timeslice_sched_s *sched);
+
+/*!
+ @brief Make a task due at once, without waiting for its timer
+ @details It may be called from another thread or from a signal handler, if TIMESLICE_ATOMIC
+ is defined. The task is appended to the ready queue like a task released by the tick, and
+ the exec that sleeps in timeslice_exec_wait() is woken. The notices that come before the
+ task executes coalesce into one execution, and the timer of the task is kept.
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_notify(timeslice_s *ctx);
+/*!
+ @brief Make a task of a timeslice scheduler due at once, without waiting for its timer
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_notify_r(timeslice_sched_s *sched, timeslice_s *ctx);
+
+/*!
+ @brief Pull the next due task of a timeslice scheduler
+ @details The tasks are pulled in the order of the policy of the scheduler, as timeslice_exec_r()
+ executes them. The caller owns the task until it is released by timeslice_call_r(),
+ and the tick does not queue the task again while it is owned.
+ It must be called from a single thread, and not together with timeslice_exec_r().
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @return timeslice_s * The due task or null
+*/
+timeslice_s *timeslice_pull_r(timeslice_sched_s *sched);
+/*!
+ @brief Execute a task pulled by timeslice_pull_r() and release it
+ @details A null task passed to the API from its function refers to it, but it is not recorded
+ as the task of timeslice_self_r().
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+ @return int bool
+  @retval 0 the task has been released
+  @retval 1 the task became due again while executing and is still owned by the caller
+*/
+int timeslice_call_r(timeslice_sched_s *sched, timeslice_s *ctx);
 
 /*!
  @brief Initialize as a cron task
+ @details The task must not be held by a scheduler, see timeslice_held().
  @param[in,out] ctx points to an instance of timeslice
  @param[in] exec A function that needs to be executed
  @param[in] argv Arguments to the executed function
@@ -54,6 +347,7 @@ void timeslice_exec(void);
 void timeslice_cron(timeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice);
 /*!
  @brief Initialize as a once task
+ @details The task must not be held by a scheduler, see timeslice_held().
  @param[in,out] ctx points to an instance of timeslice
  @param[in] exec A function that needs to be executed
  @param[in] argv Arguments to the executed function
@@ -61,6 +355,26 @@ void timeslice_cron(timeslice_s *ctx, void (*exec)(void *), void *argv, size_t s
 */
 void timeslice_once(timeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay);
 
+#if defined(TIMESLICE_IO)
+/*!
+ @brief Initialize as an io task, which is due when its file descriptor is ready
+ @details The file descriptor is watched by the epoll instance of the scheduler from the join
+ to the drop, and the exec that waits in timeslice_exec_wait() notifies the task when it is
+ ready, as timeslice_notify() does. A file descriptor is watched by one task at a time,
+ and the file descriptor of the task must stay open until the task is dropped.
+ The timeout counts the ticks since the last time that the file descriptor was ready
+ and releases the task like the slice of a cron task. On the platforms without epoll,
+ the task is only released by its timeout.
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] fd The file descriptor
+ @param[in] events The interest mask, such as TIMESLICE_POLLIN or TIMESLICE_POLLOUT
+ @param[in] timeout The length of the timeout, 0 for no timeout
+*/
+void timeslice_io(timeslice_s *ctx, void (*exec)(void *), void *argv, int fd, unsigned int events, size_t timeout);
+#endif /* TIMESLICE_IO */
+
 /*!
  @brief Set the execution function
  @param[in,out] ctx points to an instance of timeslice
@@ -86,22 +400,65 @@ void timeslice_set_timer(timeslice_s *ctx, size_t timer);
 */
 void timeslice_set_slice(timeslice_s *ctx, size_t slice);
 
+/*!
+ @brief Set the priority
+ @details When many tasks are due at once, the tasks of the higher level execute first.
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] prio Priority level, from 0 to TIMESLICE_LEVEL - 1
+*/
+void timeslice_set_prio(timeslice_s *ctx, unsigned int prio);
+
+#if defined(TIMESLICE_OVERRUN)
+/*!
+ @brief Set the policy for the periods that a task misses
+ @details A period is missed when the task is released again before it executed, or when
+ the tick advances beyond a whole period at once. The policy applies when the task executes.
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] policy TIMESLICE_OVERRUN_SKIP, TIMESLICE_OVERRUN_CATCHUP or TIMESLICE_OVERRUN_SHIFT
+ @param[in] cap The most executions that catch up after the first, up to TIMESLICE_OVERRUN_CAP
+*/
+void timeslice_set_overrun(timeslice_s *ctx, int policy, unsigned int cap);
+#endif /* TIMESLICE_OVERRUN */
+
 /*!
  @brief Join a task to the time slice list
  @param[in,out] ctx points to an instance of timeslice
 */
 void timeslice_join(timeslice_s *ctx);
+/*!
+ @brief Join a task to a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_join_r(timeslice_sched_s *sched, timeslice_s *ctx);
 /*!
  @brief Drop a task from the time slice list
+ @details Dropping a dropped task again retries to take it out of the scheduler.
  @param[in,out] ctx points to an instance of timeslice
 */
 void timeslice_drop(timeslice_s *ctx);
+/*!
+ @brief Drop a task from a timeslice scheduler
+ @details Dropping a dropped task again retries to take it out of the scheduler.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_drop_r(timeslice_sched_s *sched, timeslice_s *ctx);
 
 /*!
  @brief Testing whether a task is in the time slice list
  @param[in] ctx points to an instance of timeslice
 */
 int timeslice_exist(const timeslice_s *ctx);
+/*!
+ @brief Testing whether a scheduler still refers to a task
+ @details A task that is held must not be initialized again or freed. A dropped task is only
+ held until the tick or the exec of another thread walks it next time, while its function
+ executes, or while a caller of timeslice_pull_r() owns it. A task that polls itself from its
+ own function is always held.
+ @param[in] ctx points to an instance of timeslice
+*/
+int timeslice_held(const timeslice_s *ctx);
 
 /*!
  @brief Get the timer value for a task
@@ -115,11 +472,113 @@ size_t timeslice_timer(const timeslice_s *ctx);
  @return size_t The slice value
 */
 size_t timeslice_slice(const timeslice_s *ctx);
+/*!
+ @brief Get the priority value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return unsigned int The priority level
+*/
+unsigned int timeslice_prio(const timeslice_s *ctx);
+#if defined(TIMESLICE_OVERRUN)
+/*!
+ @brief Get the policy for the periods that a task misses
+ @param[in] ctx points to an instance of timeslice
+ @return int The overrun policy
+*/
+int timeslice_overrun(const timeslice_s *ctx);
+/*!
+ @brief Get the count of periods that a task missed before the execution
+ @details The execution of a catch-up task sees the count of periods that are left to catch up,
+ which goes down by one with each execution that catches up.
+ @param[in] ctx points to an instance of timeslice, null for the executing task
+ @return size_t The count of missed periods
+*/
+size_t timeslice_missed(const timeslice_s *ctx);
+#endif /* TIMESLICE_OVERRUN */
+#if defined(TIMESLICE_IO)
+/*!
+ @brief Get the events of the file descriptor of an io task that made it due
+ @details They are cleared after the execution, so an execution that sees none was released
+ by the timeout or by timeslice_notify().
+ @param[in] ctx points to an instance of timeslice, null for the executing task
+ @return unsigned int The ready events, such as TIMESLICE_POLLIN or TIMESLICE_POLLHUP
+*/
+unsigned int timeslice_revents(const timeslice_s *ctx);
+#endif /* TIMESLICE_IO */
 /*!
  @brief Get the count of tasks in the time slice list
  @return size_t The count of tasks
 */
 size_t timeslice_count(void);
+/*!
+ @brief Get the count of tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t timeslice_count_r(const timeslice_sched_s *sched);
+
+#if defined(TIMESLICE_TRACE)
+/*!
+ @brief Attach a trace ring to a timeslice scheduler
+ @details The scheduler records the ticks, the releases, the executions, the joins and
+ the drops. It must be called before the scheduler runs.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] trace points to an instance of trace ring or null to detach
+*/
+void timeslice_trace_attach_r(timeslice_sched_s *sched, timeslice_trace_s *trace);
+/*!
+ @brief Attach a trace ring to the default timeslice scheduler
+ @param[in] trace points to an instance of trace ring or null to detach
+*/
+void timeslice_trace_attach(timeslice_trace_s *trace);
+#endif /* TIMESLICE_TRACE */
+
+#if defined(TIMESLICE_HIST)
+/*!
+ @brief Attach a latency histogram to a timeslice scheduler
+ @details The scheduler adds the latency in nanoseconds from the moment that a task became due
+ to the start of its execution. It must be called before the scheduler runs.
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] hist points to an instance of latency histogram or null to detach
+*/
+void timeslice_hist_attach_r(timeslice_sched_s *sched, timeslice_hist_s *hist);
+/*!
+ @brief Attach a latency histogram to the default timeslice scheduler
+ @param[in] hist points to an instance of latency histogram or null to detach
+*/
+void timeslice_hist_attach(timeslice_hist_s *hist);
+#endif /* TIMESLICE_HIST */
+
+#if defined(TIMESLICE_PROFILE)
+/*!
+ @brief Get the execution profile of a task
+ @details The counters are read while the scheduler runs, so the fields of a busy task
+ may come from executions next to each other.
+ @param[in] ctx points to an instance of timeslice
+ @param[out] prof points to a copy of the execution profile
+*/
+void timeslice_prof(const timeslice_s *ctx, timeslice_prof_s *prof);
+/*!
+ @brief Reset the execution profile of a task
+ @details It must be called from the context of the exec.
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_prof_reset(timeslice_s *ctx);
+/*!
+ @brief Visit the execution profiles of the tasks in the time slice list
+ @details It must be called from the context of the tick.
+ @param[in] each A function that is called with a task, a copy of its profile and argv
+ @param[in] argv Arguments to the visiting function
+*/
+void timeslice_prof_each(void (*each)(const timeslice_s *, const timeslice_prof_s *, void *), void *argv);
+/*!
+ @brief Visit the execution profiles of the tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] each A function that is called with a task, a copy of its profile and argv
+ @param[in] argv Arguments to the visiting function
+*/
+void timeslice_prof_each_r(const timeslice_sched_s *sched,
+                           void (*each)(const timeslice_s *, const timeslice_prof_s *, void *), void *argv);
+#endif /* TIMESLICE_PROFILE */
 
 #if defined(__cplusplus)
 }
@@ -0,0 +1,197 @@
+/*!
+ @file timeslice.hpp
+ @brief C++ wrapper of cooperative scheduler timeslice.
+ @details A ts::cron stores its callable inline next to its timeslice task, in storage of the size
+ of the callable, and the trampoline that the task calls is generated for the type of the callable,
+ so neither std::function nor the heap is involved. The destruction and the move drop the task and
+ wait until the scheduler lets go of it, which is while the tick or the exec of another thread is
+ walking it or while its callable executes, so the wrapper may be destroyed or moved on any thread,
+ as in a std::vector, but not from its own callable, which would wait for itself.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_HPP__
+#define __TIMESLICE_HPP__
+
+#include "timeslice.h"
+
+#include <type_traits>
+#include <cstddef>
+#include <utility>
+#include <thread>
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+namespace ts
+{
+
+/*!
+ @brief The callable that calls a member function on an object
+ @details The member function is a template argument, so the call is resolved at compile time,
+ as in ts::cron task(10, ts::bind<&foo::tick>(&object)).
+*/
+template <auto M>
+class bind;
+
+template <typename C, typename R, bool N, R (C::*M)() noexcept(N)>
+class bind<M>
+{
+    C *obj_;
+
+public:
+    explicit bind(C *obj) noexcept
+        : obj_(obj)
+    {
+    }
+    void operator()() const noexcept(N) { (obj_->*M)(); }
+};
+
+template <typename C, typename R, bool N, R (C::*M)() const noexcept(N)>
+class bind<M>
+{
+    C const *obj_;
+
+public:
+    explicit bind(C const *obj) noexcept
+        : obj_(obj)
+    {
+    }
+    void operator()() const noexcept(N) { (obj_->*M)(); }
+};
+
+/*!
+ @brief The cron task that calls a callable on each release
+ @tparam F The type of the callable, which is called without arguments
+*/
+template <typename F>
+class cron
+{
+    timeslice_s ctx_[1];
+    timeslice_sched_s *sched_ = nullptr;
+    F fn_;
+
+    static void call_(void *argv)
+    {
+        static_cast<cron *>(argv)->fn_();
+    }
+    /* the storage of the task is free once the scheduler lets go of it and its callable has returned */
+    void release_() noexcept
+    {
+        for (drop(); timeslice_held(ctx_); drop())
+        {
+            std::this_thread::yield();
+        }
+    }
+    /* the task lets go of the scheduler before its callable is moved, and tells whether it was joined */
+    bool leave_() noexcept
+    {
+        bool joined = exist();
+        release_();
+        return joined;
+    }
+    /* the moved task keeps its timer and priority, and takes over the join of the other */
+    void take_(cron &other, bool joined) noexcept
+    {
+        timeslice_set_timer(ctx_, timeslice_timer(other.ctx_));
+        timeslice_set_prio(ctx_, timeslice_prio(other.ctx_));
+        if (joined)
+        {
+            join(other.sched_);
+        }
+    }
+    cron(cron &other, bool joined) noexcept(std::is_nothrow_move_constructible_v<F>)
+        : fn_(std::move(other.fn_))
+    {
+        timeslice_cron(ctx_, call_, this, timeslice_slice(other.ctx_));
+        take_(other, joined);
+    }
+
+public:
+    /*!
+     @brief Initialize as a cron task
+     @param[in] slice The length of the time slice
+     @param[in] fn The callable that needs to be executed
+    */
+    cron(std::size_t slice, F fn) noexcept(std::is_nothrow_move_constructible_v<F>)
+        : fn_(std::move(fn))
+    {
+        timeslice_cron(ctx_, call_, this, slice);
+    }
+    cron(cron const &) = delete;
+    cron &operator=(cron const &) = delete;
+    /*!
+     @brief Move a task, which leaves the scheduler and joins again at the new address
+    */
+    cron(cron &&other) noexcept(std::is_nothrow_move_constructible_v<F>)
+        : cron(other, other.leave_())
+    {
+    }
+    cron &operator=(cron &&other) noexcept(std::is_nothrow_move_assignable_v<F>)
+    {
+        if (this != &other)
+        {
+            release_();
+            bool joined = other.leave_();
+            fn_ = std::move(other.fn_);
+            timeslice_set_slice(ctx_, timeslice_slice(other.ctx_));
+            take_(other, joined);
+        }
+        return *this;
+    }
+    ~cron() { release_(); }
+
+    /*!
+     @brief Join the task to a timeslice scheduler
+     @param[in,out] sched points to an instance of timeslice scheduler, null for the default one
+    */
+    void join(timeslice_sched_s *sched = nullptr) noexcept
+    {
+        sched_ = sched;
+        if (sched)
+        {
+            timeslice_join_r(sched, ctx_);
+        }
+        else
+        {
+            timeslice_join(ctx_);
+        }
+    }
+    /*!
+     @brief Drop the task from its timeslice scheduler
+    */
+    void drop() noexcept
+    {
+        if (sched_)
+        {
+            timeslice_drop_r(sched_, ctx_);
+        }
+        else
+        {
+            timeslice_drop(ctx_);
+        }
+    }
+    /*!
+     @brief Testing whether the task is in a timeslice scheduler
+    */
+    bool exist() const noexcept { return timeslice_exist(ctx_) != 0; }
+    /*!
+     @brief Get the timeslice task
+     @return timeslice_s * The task, for the functions of timeslice such as timeslice_set_timer()
+    */
+    timeslice_s *get() noexcept { return ctx_; }
+    /*!
+     @brief Get the callable
+    */
+    F &function() noexcept { return fn_; }
+};
+
+} /* namespace ts */
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#endif /* __TIMESLICE_HPP__ */
@@ -0,0 +1,322 @@
+/*!
+ @file timeslice_coro.hpp
+ @brief C++20 coroutine tasks of cooperative scheduler timeslice.
+ @details A coroutine that returns ts::task is a timeslice task whose function resumes the
+ coroutine, so it is resumed by timeslice_exec(). It suspends with co_await ts::sleep(ticks)
+ until its timer runs out, or with co_await ts::next_tick() until the next tick, and it drops
+ itself when it returns. The frames come from a fixed pool of TIMESLICE_CORO_COUNT blocks of
+ TIMESLICE_CORO_FRAME bytes, so neither the creation nor the suspension allocates from the heap,
+ and a coroutine whose frame does not fit into a free block returns an empty task.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_CORO_HPP__
+#define __TIMESLICE_CORO_HPP__
+
+#include "timeslice.h"
+
+#include <coroutine>
+#include <exception>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+
+#if !defined(TIMESLICE_CORO_FRAME)
+/*!
+ @brief The size of a block of the frame pool, which bounds the size of a coroutine frame
+ @details The frame holds the timeslice task in its promise, and the default leaves 256 bytes
+ for the arguments, the locals and the state of the coroutine.
+*/
+#define TIMESLICE_CORO_FRAME (sizeof(timeslice_s) + 256)
+#endif /* TIMESLICE_CORO_FRAME */
+#if !defined(TIMESLICE_CORO_COUNT)
+/*!
+ @brief The count of blocks of the frame pool, which bounds the count of live coroutines
+*/
+#define TIMESLICE_CORO_COUNT 64
+#endif /* TIMESLICE_CORO_COUNT */
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+namespace ts
+{
+
+/*!
+ @brief The fixed pool that the coroutine frames come from
+ @details The blocks are handed out from the end of the pool until it is used up,
+ and the blocks that are given back are reused first. It is guarded by a spin lock,
+ so the coroutines may be created and destroyed on different threads.
+*/
+class frame_pool
+{
+    union block
+    {
+        block *next;
+        alignas(std::max_align_t) unsigned char data[TIMESLICE_CORO_FRAME];
+    };
+    static inline block pool_[TIMESLICE_CORO_COUNT];
+    static inline block *free_ = nullptr;
+    static inline std::size_t used_ = 0;
+    static inline std::size_t live_ = 0;
+    static inline std::atomic_flag lock_;
+
+    static void lock() noexcept
+    {
+        while (lock_.test_and_set(std::memory_order_acquire))
+        {
+        }
+    }
+    static void unlock() noexcept
+    {
+        lock_.clear(std::memory_order_release);
+    }
+
+public:
+    /*!
+     @brief Take a block for a frame
+     @param[in] size The size of the frame
+     @return void * The block, or null if the frame is too large or the pool is used up
+    */
+    static void *allocate(std::size_t size) noexcept
+    {
+        block *ctx = nullptr;
+        if (size > sizeof(block))
+        {
+            return ctx;
+        }
+        lock();
+        if (free_)
+        {
+            ctx = free_;
+            free_ = ctx->next;
+        }
+        else if (used_ != TIMESLICE_CORO_COUNT)
+        {
+            ctx = pool_ + used_++;
+        }
+        live_ += ctx != nullptr;
+        unlock();
+        return ctx;
+    }
+    /*!
+     @brief Give a block back to the pool
+     @param[in] ptr points to a block taken by allocate()
+    */
+    static void deallocate(void *ptr) noexcept
+    {
+        block *ctx = static_cast<block *>(ptr);
+        lock();
+        ctx->next = free_;
+        free_ = ctx;
+        --live_;
+        unlock();
+    }
+    /*!
+     @brief Get the count of blocks in use
+     @return std::size_t The count of live frames
+    */
+    static std::size_t count() noexcept
+    {
+        lock();
+        std::size_t live = live_;
+        unlock();
+        return live;
+    }
+};
+
+/*!
+ @brief The handle of a coroutine that runs as a timeslice task
+ @details The task owns the frame and gives it back when it is destroyed. The destruction drops
+ the task and waits until the scheduler lets go of it, which takes a wait while the tick or the
+ exec of another thread is walking it or resuming the coroutine, so the frame is neither destroyed
+ while it executes nor reused while it is still queued. A task must not be destroyed from its own
+ coroutine, which would wait for itself.
+*/
+class task
+{
+public:
+    struct promise_type;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    /*!
+     @brief The promise of a coroutine task, which embeds its timeslice task
+    */
+    struct promise_type
+    {
+        timeslice_s ctx[1];
+        timeslice_sched_s *sched = nullptr;
+        bool started = false;
+
+        static void resume(void *argv)
+        {
+            handle_type::from_address(argv).resume();
+        }
+        void drop() noexcept
+        {
+            if (sched)
+            {
+                timeslice_drop_r(sched, ctx);
+            }
+            else
+            {
+                timeslice_drop(ctx);
+            }
+        }
+
+        static void *operator new(std::size_t size) noexcept
+        {
+            return frame_pool::allocate(size);
+        }
+        static void operator delete(void *ptr) noexcept
+        {
+            frame_pool::deallocate(ptr);
+        }
+        static task get_return_object_on_allocation_failure() noexcept
+        {
+            return task();
+        }
+        task get_return_object() noexcept
+        {
+            handle_type handle = handle_type::from_promise(*this);
+            /* the timer only runs while the coroutine sleeps */
+            timeslice_cron(ctx, resume, handle.address(), 0);
+            return task(handle);
+        }
+
+        struct final_awaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(handle_type handle) const noexcept { handle.promise().drop(); }
+            void await_resume() const noexcept {}
+        };
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        final_awaiter final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    task() noexcept = default;
+    task(task const &) = delete;
+    task &operator=(task const &) = delete;
+    task(task &&other) noexcept
+        : handle_(other.handle_)
+    {
+        other.handle_ = nullptr;
+    }
+    task &operator=(task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            handle_ = other.handle_;
+            other.handle_ = nullptr;
+        }
+        return *this;
+    }
+    ~task() { reset(); }
+
+    /*!
+     @brief Join the task to a timeslice scheduler
+     @details The first join resumes the coroutine on the next execution, without waiting for
+     a tick, and a join after a drop continues with the timer that the coroutine sleeps on.
+     @param[in,out] sched points to an instance of timeslice scheduler, null for the default one
+    */
+    void join(timeslice_sched_s *sched = nullptr) noexcept
+    {
+        promise_type &promise = handle_.promise();
+        promise.sched = sched;
+        if (sched)
+        {
+            timeslice_join_r(sched, promise.ctx);
+        }
+        else
+        {
+            timeslice_join(promise.ctx);
+        }
+        if (!promise.started)
+        {
+            promise.started = true;
+            if (sched)
+            {
+                timeslice_notify_r(sched, promise.ctx);
+            }
+            else
+            {
+                timeslice_notify(promise.ctx);
+            }
+        }
+    }
+    /*!
+     @brief Drop the task from its timeslice scheduler
+    */
+    void drop() noexcept { handle_.promise().drop(); }
+    /*!
+     @brief Testing whether the coroutine has returned
+    */
+    bool done() const noexcept { return handle_.done(); }
+    /*!
+     @brief Get the timeslice task that resumes the coroutine
+     @return timeslice_s * The task, for the functions of timeslice such as timeslice_set_prio()
+    */
+    timeslice_s *get() const noexcept { return handle_.promise().ctx; }
+    /*!
+     @brief Testing whether the task has a frame
+    */
+    explicit operator bool() const noexcept { return handle_ != nullptr; }
+
+private:
+    explicit task(handle_type handle) noexcept
+        : handle_(handle)
+    {
+    }
+    void reset() noexcept
+    {
+        if (handle_)
+        {
+            promise_type &promise = handle_.promise();
+            /* the frame is only destroyed once the coroutine is neither queued nor executing */
+            for (promise.drop(); timeslice_held(promise.ctx); promise.drop())
+            {
+                std::this_thread::yield();
+            }
+            handle_.destroy();
+            handle_ = nullptr;
+        }
+    }
+    handle_type handle_ = nullptr;
+};
+
+/*!
+ @brief The awaiter that suspends a coroutine task for a count of ticks
+ @details The timer of the task is set when the coroutine suspends, and the task is resumed by
+ the execution after the tick that runs the timer out. A sleep of zero ticks lasts until the next tick.
+*/
+class sleep
+{
+    std::size_t ticks_;
+
+public:
+    explicit sleep(std::size_t ticks) noexcept
+        : ticks_(ticks ? ticks : 1)
+    {
+    }
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(task::handle_type handle) const noexcept { timeslice_set_timer(handle.promise().ctx, ticks_); }
+    void await_resume() const noexcept {}
+};
+
+/*!
+ @brief Get the awaiter that suspends a coroutine task until the next tick
+*/
+inline sleep next_tick() noexcept { return sleep(1); }
+
+} /* namespace ts */
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#endif /* __TIMESLICE_CORO_HPP__ */
@@ -0,0 +1,89 @@
+/*!
+ @file timeslice_hist.h
+ @brief Latency histogram with log-linear buckets.
+ @details The values below 2 << TIMESLICE_HIST_BITS are counted exactly, and every doubling
+ above them is split into 1 << TIMESLICE_HIST_BITS buckets, so a value is reported within
+ a relative error of 1 / (1 << TIMESLICE_HIST_BITS). The values from 1 << TIMESLICE_HIST_MAX
+ go into the last bucket. A scheduler feeds its histogram with the latencies from the release
+ of the tasks to the start of their execution only if TIMESLICE_HIST is defined,
+ which is done by configuring with ENABLE_HIST.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_HIST_H__
+#define __TIMESLICE_HIST_H__
+
+#include <stdint.h>
+
+#if !defined TIMESLICE_HIST_BITS
+/*!
+ @brief The count of bits of the buckets within a doubling
+*/
+#define TIMESLICE_HIST_BITS 5
+#endif /* TIMESLICE_HIST_BITS */
+#if !defined TIMESLICE_HIST_MAX
+/*!
+ @brief The count of bits of the largest value that is told apart
+*/
+#define TIMESLICE_HIST_MAX 36
+#endif /* TIMESLICE_HIST_MAX */
+/*!
+ @brief The count of buckets
+*/
+#define TIMESLICE_HIST_SIZE ((TIMESLICE_HIST_MAX - TIMESLICE_HIST_BITS + 1) << TIMESLICE_HIST_BITS)
+
+/*!
+ @brief Instance structure for latency histogram
+*/
+typedef struct timeslice_hist_s
+{
+    uint64_t count[TIMESLICE_HIST_SIZE]; //!< the count of values in each bucket
+    uint64_t total; //!< the count of values
+    uint64_t max; //!< the largest value
+} timeslice_hist_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Reset a latency histogram
+ @param[in,out] ctx points to an instance of latency histogram
+*/
+void timeslice_hist_reset(timeslice_hist_s *ctx);
+
+/*!
+ @brief Add a value to a latency histogram
+ @details It does not allocate and may be called from many threads at once.
+ @param[in,out] ctx points to an instance of latency histogram
+ @param[in] value The value, in nanoseconds for the latencies of a scheduler
+*/
+void timeslice_hist_add(timeslice_hist_s *ctx, uint64_t value);
+
+/*!
+ @brief Get a quantile of a latency histogram
+ @param[in] ctx points to an instance of latency histogram
+ @param[in] q The quantile from 0 to 1, such as 0.5, 0.99 or 0.999
+ @return uint64_t The largest value of the bucket of the quantile, not beyond the largest value
+*/
+uint64_t timeslice_hist_quantile(const timeslice_hist_s *ctx, double q);
+
+/*!
+ @brief Get the largest value of a latency histogram
+ @param[in] ctx points to an instance of latency histogram
+ @return uint64_t The largest value
+*/
+uint64_t timeslice_hist_max(const timeslice_hist_s *ctx);
+
+/*!
+ @brief Get the count of values of a latency histogram
+ @param[in] ctx points to an instance of latency histogram
+ @return uint64_t The count of values
+*/
+uint64_t timeslice_hist_total(const timeslice_hist_s *ctx);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __TIMESLICE_HIST_H__ */
@@ -0,0 +1,76 @@
+/*!
+ @file timeslice_pool.h
+ @brief Multi-core executor for timeslice with per-worker deques and work stealing.
+ @details Each worker thread calls timeslice_pool_work() with its own index. A worker whose
+ deque is empty pulls the next due task from the scheduler, one worker at a time, so the tasks
+ start in the order of the policy of the scheduler, by priority or by deadline, as
+ timeslice_pull_r() returns them. A task that became due again while executing goes back
+ to the deque of its worker, and the idle workers steal it from there. A task never runs
+ concurrently with itself, so a cron task keeps its ordering. A null task passed to the API
+ from a callback refers to the task executing on the calling worker. It requires TIMESLICE_ATOMIC.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_POOL_H__
+#define __TIMESLICE_POOL_H__
+
+#include "timeslice.h"
+
+#if !defined(TIMESLICE_ATOMIC)
+#error "timeslice_pool requires TIMESLICE_ATOMIC"
+#endif /* TIMESLICE_ATOMIC */
+
+#if !defined TIMESLICE_DEQUE
+/*!
+ @brief The capacity of the deque of a worker, which must be a power of two
+*/
+#define TIMESLICE_DEQUE 256
+#endif /* TIMESLICE_DEQUE */
+
+/*!
+ @brief Instance structure for the deque of a worker
+*/
+typedef struct timeslice_deque_s
+{
+    timeslice_s *slot[TIMESLICE_DEQUE];
+    size_t top;
+    size_t bottom;
+} timeslice_deque_s;
+
+/*!
+ @brief Instance structure for timeslice executor
+*/
+typedef struct timeslice_pool_s
+{
+    timeslice_sched_s *sched;
+    timeslice_deque_s *deque;
+    size_t count;
+    size_t pull;
+} timeslice_pool_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a timeslice executor
+ @param[in,out] pool points to an instance of timeslice executor
+ @param[in] sched points to the scheduler whose due tasks are executed
+ @param[in] deque points to an array of deques, one for each worker
+ @param[in] count The count of workers
+*/
+void timeslice_pool_init(timeslice_pool_s *pool, timeslice_sched_s *sched, timeslice_deque_s *deque, size_t count);
+
+/*!
+ @brief Execute the due tasks on a worker until none is left for it
+ @param[in,out] pool points to an instance of timeslice executor
+ @param[in] id The index of the worker calling this function
+ @return size_t The count of executions
+*/
+size_t timeslice_pool_work(timeslice_pool_s *pool, size_t id);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __TIMESLICE_POOL_H__ */
@@ -0,0 +1,50 @@
+/*!
+ @file timeslice_prof.h
+ @brief Execution profile of a timeslice task.
+ @details The profile is compiled in only if TIMESLICE_PROFILE is defined,
+ which is done by configuring with ENABLE_PROFILE. The times are in nanoseconds
+ of a monotonic clock, and a release is the moment that the task became due.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_PROF_H__
+#define __TIMESLICE_PROF_H__
+
+#include <stdint.h>
+
+/*!
+ @brief Instance structure for the execution profile of a task
+*/
+typedef struct timeslice_prof_s
+{
+    uint64_t count; //!< the count of executions
+    uint64_t missed; //!< the count of releases that found the task still due
+    uint64_t run_min; //!< the minimum run time of the execution function
+    uint64_t run_max; //!< the maximum run time of the execution function
+    uint64_t run_sum; //!< the total run time of the execution function
+    uint64_t lat_min; //!< the minimum latency from the release to the start
+    uint64_t lat_max; //!< the maximum latency from the release to the start
+    uint64_t lat_sum; //!< the total latency from the release to the start
+} timeslice_prof_s;
+
+/*!
+ @brief Get the mean run time of the execution function
+ @param[in] prof points to an execution profile
+ @return uint64_t The mean run time
+*/
+static inline uint64_t timeslice_prof_run(const timeslice_prof_s *prof)
+{
+    return prof->count ? prof->run_sum / prof->count : 0;
+}
+
+/*!
+ @brief Get the mean latency from the release to the start
+ @param[in] prof points to an execution profile
+ @return uint64_t The mean latency
+*/
+static inline uint64_t timeslice_prof_lat(const timeslice_prof_s *prof)
+{
+    return prof->count ? prof->lat_sum / prof->count : 0;
+}
+
+#endif /* __TIMESLICE_PROF_H__ */
@@ -0,0 +1,104 @@
+/*!
+ @file timeslice_sim.h
+ @brief Virtual-time simulation driver for timeslice.
+ @details The driver runs a scheduler on a single virtual cpu without waiting for a clock.
+ It executes the due tasks, moves the virtual time forward by the cost of each execution,
+ applies the ticks that elapsed meanwhile and jumps straight to the next expiry when idle.
+ The execution function and the arguments of each added task are wrapped by the driver,
+ so the callbacks still run, but must not change their own execution function or arguments
+ while they are added. The tick and the exec must not be driven by anything else meanwhile.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_SIM_H__
+#define __TIMESLICE_SIM_H__
+
+#include "timeslice.h"
+
+/*!
+ @brief Instance structure for the simulation of a task
+*/
+typedef struct timeslice_sim_task_s
+{
+    struct timeslice_sim_s *sim;
+    timeslice_s *ctx; //!< the simulated task
+    void (*exec)(void *); //!< the execution function of the task
+    void *argv; //!< the arguments of the task
+    uint64_t count; //!< the count of executions
+    uint64_t busy; //!< the total cost of the executions
+    uint64_t resp_min; //!< the minimum response time from the release to the end
+    uint64_t resp_max; //!< the maximum response time from the release to the end
+    uint64_t resp_sum; //!< the total response time from the release to the end
+} timeslice_sim_task_s;
+
+/*!
+ @brief Instance structure for virtual-time simulation driver
+*/
+typedef struct timeslice_sim_s
+{
+    timeslice_sched_s *sched; //!< the driven scheduler
+    uint64_t (*cost)(const timeslice_s *ctx, void *argv); //!< the cost function of the executions
+    void *argv; //!< the arguments of the cost function
+    uint64_t period; //!< the virtual time of a tick
+    uint64_t now; //!< the virtual time
+    uint64_t busy; //!< the virtual time spent executing
+    size_t base; //!< the tick count of the scheduler at the virtual time zero
+} timeslice_sim_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a virtual-time simulation driver
+ @param[in,out] sim points to an instance of virtual-time simulation driver
+ @param[in] sched points to the scheduler to drive
+ @param[in] period The virtual time of a tick, such as 1000000 for a 1 kHz tick in nanoseconds
+ @param[in] cost A function that returns the virtual time of an execution of a task, or null for no cost
+ @param[in] argv Arguments to the cost function
+*/
+void timeslice_sim_init(timeslice_sim_s *sim, timeslice_sched_s *sched, uint64_t period,
+                        uint64_t (*cost)(const timeslice_s *, void *), void *argv);
+
+/*!
+ @brief Add a task to the simulation
+ @details The task is wrapped, but it is neither joined nor dropped.
+ @param[in,out] sim points to an instance of virtual-time simulation driver
+ @param[out] task points to the simulation of the task
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void timeslice_sim_add(timeslice_sim_s *sim, timeslice_sim_task_s *task, timeslice_s *ctx);
+
+/*!
+ @brief Remove a task from the simulation, restoring its execution function and arguments
+ @param[in,out] task points to the simulation of the task
+*/
+void timeslice_sim_del(timeslice_sim_task_s *task);
+
+/*!
+ @brief Run the simulation for a span of virtual time
+ @param[in,out] sim points to an instance of virtual-time simulation driver
+ @param[in] span The virtual time to run
+ @return uint64_t The virtual time at the end, which may run past the span by the last execution
+*/
+uint64_t timeslice_sim_run(timeslice_sim_s *sim, uint64_t span);
+
+/*!
+ @brief Get the utilization of the virtual cpu
+ @param[in] sim points to an instance of virtual-time simulation driver
+ @return double The fraction of the virtual time spent executing
+*/
+double timeslice_sim_util(const timeslice_sim_s *sim);
+
+/*!
+ @brief Get the utilization of the virtual cpu by a task
+ @param[in] task points to the simulation of a task
+ @return double The fraction of the virtual time spent executing the task
+*/
+double timeslice_sim_task_util(const timeslice_sim_task_s *task);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __TIMESLICE_SIM_H__ */
@@ -0,0 +1,104 @@
+/*!
+ @file timeslice_ticker.h
+ @brief Linux tick source that drives timeslice from timerfd or clock_nanosleep.
+ @details The ticker thread waits for absolute deadlines on CLOCK_MONOTONIC, so it does not drift.
+ The expirations that were missed are applied as catch-up ticks with timeslice_advance_r().
+ The exec runs on another thread than the ticker, so it requires TIMESLICE_ATOMIC.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_TICKER_H__
+#define __TIMESLICE_TICKER_H__
+
+#include "timeslice.h"
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <stdint.h>
+
+/*!
+ @brief Instance structure for the statistics of timeslice ticker
+*/
+typedef struct timeslice_ticker_stat_s
+{
+    uint64_t ticks; //!< the count of ticks applied to the scheduler
+    uint64_t wakeups; //!< the count of times the ticker thread woke up
+    uint64_t overruns; //!< the count of periods that were missed and applied late as catch-up ticks
+    uint64_t jitter_min; //!< the minimum delay of a wakeup after its first pending deadline in nanoseconds
+    uint64_t jitter_max; //!< the maximum delay of a wakeup after its first pending deadline in nanoseconds
+    uint64_t jitter_sum; //!< the sum of delays of the wakeups in nanoseconds
+} timeslice_ticker_stat_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief Instance structure for timeslice ticker
+*/
+typedef struct timeslice_ticker_s
+{
+    timeslice_sched_s *sched;
+    timeslice_ticker_stat_s stat[1];
+    uint64_t period;
+    pthread_t thread;
+    int mode;
+    int cpu;
+    int stop;
+    int fd;
+    int started;
+} timeslice_ticker_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief The ways to wait for the next tick
+*/
+enum
+{
+    TIMESLICE_TICKER_NANOSLEEP, //!< absolute clock_nanosleep(TIMER_ABSTIME)
+    TIMESLICE_TICKER_TIMERFD, //!< periodic timerfd and its expiration count
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Start a thread that ticks a timeslice scheduler
+ @param[in,out] ctx points to an instance of timeslice ticker
+ @param[in] sched points to the scheduler to tick
+ @param[in] period The tick period in nanoseconds
+ @param[in] mode The way to wait for the next tick
+ @param[in] cpu The cpu to pin the ticker thread to, or -1
+ @return int error code
+  @retval 0 success
+  @retval errno failure
+*/
+int timeslice_ticker_start(timeslice_ticker_s *ctx, timeslice_sched_s *sched, uint64_t period, int mode, int cpu);
+
+/*!
+ @brief Stop the thread of a timeslice ticker and wait for it
+ @details It does nothing if the ticker was not started, so it is safe after a failed start.
+ @param[in,out] ctx points to an instance of timeslice ticker
+*/
+void timeslice_ticker_stop(timeslice_ticker_s *ctx);
+
+/*!
+ @brief Get a snapshot of the statistics of a timeslice ticker
+ @param[in] ctx points to an instance of timeslice ticker
+ @param[out] stat points to the statistics
+*/
+void timeslice_ticker_stat(const timeslice_ticker_s *ctx, timeslice_ticker_stat_s *stat);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __linux__ */
+
+#endif /* __TIMESLICE_TICKER_H__ */
@@ -0,0 +1,94 @@
+/*!
+ @file timeslice_trace.h
+ @brief Binary trace of the events of a timeslice scheduler.
+ @details A scheduler adds records only if TIMESLICE_TRACE is defined, which is done by
+ configuring with ENABLE_TRACE. The records go into a ring that is attached to a scheduler
+ and overwrites its oldest records, and any thread may add a record without a lock.
+ The records that are read out can be saved as they are and converted to the trace event
+ JSON of Chrome by the timeslice_trace2json tool.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __TIMESLICE_TRACE_H__
+#define __TIMESLICE_TRACE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ @brief The events of a timeslice scheduler
+*/
+enum
+{
+    TIMESLICE_TRACE_TICK, //!< the tick applied arg ticks
+    TIMESLICE_TRACE_DUE, //!< the task became due
+    TIMESLICE_TRACE_START, //!< the execution function of the task started
+    TIMESLICE_TRACE_END, //!< the execution function of the task returned
+    TIMESLICE_TRACE_JOIN, //!< the task was joined
+    TIMESLICE_TRACE_DROP, //!< the task was dropped
+};
+
+/*!
+ @brief Instance structure for trace record, 16 bytes
+*/
+typedef struct timeslice_trace_rec_s
+{
+    uint64_t time; //!< the time in nanoseconds of a monotonic clock
+    uint32_t task; //!< the low 32 bits of the address of the task, or 0
+    uint16_t event; //!< the event
+    uint16_t arg; //!< the argument of the event, saturated
+} timeslice_trace_rec_s;
+
+/*!
+ @brief Instance structure for trace ring
+*/
+typedef struct timeslice_trace_s
+{
+    timeslice_trace_rec_s *ring; //!< the records
+    size_t mask; //!< the capacity minus one
+    size_t tail; //!< the count of records that have been added
+} timeslice_trace_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a trace ring
+ @param[in,out] ctx points to an instance of trace ring
+ @param[in] ring points to the memory of the records
+ @param[in] count The capacity of the ring, which must be a power of two
+*/
+void timeslice_trace_init(timeslice_trace_s *ctx, timeslice_trace_rec_s *ring, size_t count);
+
+/*!
+ @brief Add a record to a trace ring
+ @param[in,out] ctx points to an instance of trace ring
+ @param[in] event The event
+ @param[in] task points to the task of the event or null
+ @param[in] arg The argument of the event
+*/
+void timeslice_trace_put(timeslice_trace_s *ctx, unsigned int event, const void *task, size_t arg);
+
+/*!
+ @brief Read the latest records of a trace ring, the oldest first
+ @details The records that are being added meanwhile may be torn, so it is best called while
+ the scheduler is quiet.
+ @param[in] ctx points to an instance of trace ring
+ @param[out] rec points to the memory of the records
+ @param[in] count The capacity of the memory
+ @return size_t The count of records that have been read
+*/
+size_t timeslice_trace_read(const timeslice_trace_s *ctx, timeslice_trace_rec_s *rec, size_t count);
+
+/*!
+ @brief Reset a trace ring
+ @param[in,out] ctx points to an instance of trace ring
+*/
+void timeslice_trace_reset(timeslice_trace_s *ctx);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __TIMESLICE_TRACE_H__ */
@@ -0,0 +1,173 @@
+/*!
+ @file vtimeslice.h
+ @brief Cooperative timeslice scheduler implementation with a structure-of-arrays timer table.
+ @details The timers and the slices of the tasks are kept in separate 32-bit arrays, and the due
+ tasks are kept in a bitmap. The tick counts down 8 timers per instruction with AVX2, chosen at run
+ time, 4 with SSE2, or one by one elsewhere, reloads the expired timers from the slices with
+ a masked blend and ors the expired lanes into the bitmap. The exec visits the bitmap with
+ count-trailing-zeros. The tasks are referred to by their index in the table, and the memory
+ of the table is given by the caller. The tick must run in the same context as the exec.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __VTIMESLICE_H__
+#define __VTIMESLICE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ @brief Instance structure for the execution function of a task
+*/
+typedef struct vtimeslice_call_s
+{
+    void (*exec)(void *);
+    void *argv;
+} vtimeslice_call_s;
+
+/*!
+ @brief The count of bytes of the table for a count of tasks, which is rounded up to 64
+*/
+#define VTIMESLICE_MEMORY(count) \
+    (((count) + 63) / 64 * (64 * (sizeof(vtimeslice_call_s) + 3 * sizeof(uint32_t)) + 3 * sizeof(uint64_t)))
+
+/*!
+ @brief Instance structure for timeslice scheduler
+*/
+typedef struct vtimeslice_sched_s
+{
+    vtimeslice_call_s *call;
+    uint64_t *ready;
+    uint64_t *join;
+    uint64_t *once;
+    uint32_t *timer;
+    uint32_t *slice;
+    uint32_t *saved;
+    size_t count;
+    size_t counter;
+    size_t ctx;
+} vtimeslice_sched_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] memory points to the memory of the table, aligned like a pointer
+ @param[in] count The count of tasks, the memory holds VTIMESLICE_MEMORY(count) bytes
+*/
+void vtimeslice_sched_init(vtimeslice_sched_s *sched, void *memory, size_t count);
+/*!
+ @brief Get the task that is being executed by a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The index of the task of the last execution
+*/
+size_t vtimeslice_self_r(const vtimeslice_sched_s *sched);
+
+/*!
+ @brief A function that requires the tick timer to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void vtimeslice_tick_r(vtimeslice_sched_s *sched);
+/*!
+ @brief A function that requires the cpu to execute
+ @param[in,out] sched points to an instance of timeslice scheduler
+*/
+void vtimeslice_exec_r(vtimeslice_sched_s *sched);
+
+/*!
+ @brief Initialize as a cron task
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] slice The length of the time slice
+*/
+void vtimeslice_cron_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t slice);
+/*!
+ @brief Initialize as a once task
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] delay The length of delayed execution
+*/
+void vtimeslice_once_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t delay);
+
+/*!
+ @brief Set the execution function
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] exec A function that needs to be executed
+*/
+void vtimeslice_set_exec_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *));
+/*!
+ @brief Set the arguments
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] argv Arguments to the executed function
+*/
+void vtimeslice_set_argv_r(vtimeslice_sched_s *sched, size_t id, void *argv);
+/*!
+ @brief Set the timer
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] timer Timer value
+*/
+void vtimeslice_set_timer_r(vtimeslice_sched_s *sched, size_t id, size_t timer);
+/*!
+ @brief Set the slice
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @param[in] slice Slice value
+*/
+void vtimeslice_set_slice_r(vtimeslice_sched_s *sched, size_t id, size_t slice);
+
+/*!
+ @brief Join a task to a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+void vtimeslice_join_r(vtimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Drop a task from a timeslice scheduler
+ @param[in,out] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+void vtimeslice_drop_r(vtimeslice_sched_s *sched, size_t id);
+
+/*!
+ @brief Testing whether a task is in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+*/
+int vtimeslice_exist_r(const vtimeslice_sched_s *sched, size_t id);
+
+/*!
+ @brief Get the timer value for a task
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @return size_t The timer value
+*/
+size_t vtimeslice_timer_r(const vtimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Get the slice value for a task
+ @param[in] sched points to an instance of timeslice scheduler
+ @param[in] id The index of the task
+ @return size_t The slice value
+*/
+size_t vtimeslice_slice_r(const vtimeslice_sched_s *sched, size_t id);
+/*!
+ @brief Get the count of tasks in a timeslice scheduler
+ @param[in] sched points to an instance of timeslice scheduler
+ @return size_t The count of tasks
+*/
+size_t vtimeslice_count_r(const vtimeslice_sched_s *sched);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __VTIMESLICE_H__ */
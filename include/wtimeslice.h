@@ -0,0 +1,141 @@
+/*!
+ @file wtimeslice.h
+ @brief Cooperative timeslice scheduler implementation based on hierarchical timing wheel.
+ @details A tick only touches the tasks that expire in the current slot.
+ The tick and the exec must be called from the same context.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __WTIMESLICE_H__
+#define __WTIMESLICE_H__
+
+#include "list.h"
+
+/*!
+ @brief The number of bits of slots per level of the timing wheel
+*/
+#define WTIMESLICE_BITS 6
+/*!
+ @brief The number of levels of the timing wheel
+*/
+#define WTIMESLICE_LEVEL 4
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief Instance structure for timeslice
+*/
+typedef struct wtimeslice_s
+{
+    list_s node[1];
+    list_s ready[1];
+    size_t slice;
+    size_t timer;
+    size_t expire;
+    void (*exec)(void *);
+    void *argv;
+    int stat;
+} wtimeslice_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief A function that requires the tick timer to execute
+*/
+void wtimeslice_tick(void);
+/*!
+ @brief A function that requires the cpu to execute
+*/
+void wtimeslice_exec(void);
+
+/*!
+ @brief Initialize as a cron task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] slice The length of the time slice
+*/
+void wtimeslice_cron(wtimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice);
+/*!
+ @brief Initialize as a once task
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+ @param[in] argv Arguments to the executed function
+ @param[in] delay The length of delayed execution
+*/
+void wtimeslice_once(wtimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay);
+
+/*!
+ @brief Set the execution function
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] exec A function that needs to be executed
+*/
+void wtimeslice_set_exec(wtimeslice_s *ctx, void (*exec)(void *));
+/*!
+ @brief Set the arguments
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] argv Arguments to the executed function
+*/
+void wtimeslice_set_argv(wtimeslice_s *ctx, void *argv);
+/*!
+ @brief Set the timer
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] timer Timer value
+*/
+void wtimeslice_set_timer(wtimeslice_s *ctx, size_t timer);
+/*!
+ @brief Set the slice
+ @param[in,out] ctx points to an instance of timeslice
+ @param[in] slice Slice value
+*/
+void wtimeslice_set_slice(wtimeslice_s *ctx, size_t slice);
+
+/*!
+ @brief Join a task to the timing wheel
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void wtimeslice_join(wtimeslice_s *ctx);
+/*!
+ @brief Drop a task from the timing wheel
+ @param[in,out] ctx points to an instance of timeslice
+*/
+void wtimeslice_drop(wtimeslice_s *ctx);
+
+/*!
+ @brief Testing whether a task is in the timing wheel
+ @param[in] ctx points to an instance of timeslice
+*/
+int wtimeslice_exist(const wtimeslice_s *ctx);
+
+/*!
+ @brief Get the timer value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The timer value
+*/
+size_t wtimeslice_timer(const wtimeslice_s *ctx);
+/*!
+ @brief Get the slice value for a task
+ @param[in] ctx points to an instance of timeslice
+ @return size_t The slice value
+*/
+size_t wtimeslice_slice(const wtimeslice_s *ctx);
+/*!
+ @brief Get the count of tasks in the timing wheel
+ @return size_t The count of tasks
+*/
+size_t wtimeslice_count(void);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __WTIMESLICE_H__ */
@@ -0,0 +1,58 @@
+/*!
+ @file atomic.h
+ @brief Atomic operations used by the cross-thread mode of timeslice.
+ @details If TIMESLICE_ATOMIC is defined, the operations map onto the __atomic builtins,
+ otherwise they are plain memory accesses for single context usage.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __ATOMIC_H__
+#define __ATOMIC_H__
+
+#include <stddef.h>
+
+#if defined(TIMESLICE_ATOMIC)
+
+#if !defined(__GNUC__) && !defined(__clang__)
+#error "TIMESLICE_ATOMIC requires the __atomic builtins of GCC or Clang"
+#endif /* __GNUC__ || __clang__ */
+
+#define ATOMIC_LOAD(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(var, val) __atomic_store_n(&(var), (val), __ATOMIC_RELEASE)
+#define ATOMIC_OR(var, val) __atomic_fetch_or(&(var), (val), __ATOMIC_ACQ_REL)
+#define ATOMIC_AND(var, val) __atomic_fetch_and(&(var), (val), __ATOMIC_ACQ_REL)
+#define ATOMIC_ADD(var, val) __atomic_fetch_add(&(var), (val), __ATOMIC_RELAXED)
+#define ATOMIC_SUB(var, val) __atomic_fetch_sub(&(var), (val), __ATOMIC_RELAXED)
+#define ATOMIC_XCHG(var, val) __atomic_exchange_n(&(var), (val), __ATOMIC_ACQ_REL)
+#define ATOMIC_CAS(var, exp, val) __atomic_compare_exchange_n(&(var), &(exp), (val), 0, __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define ATOMIC_LOCAL __thread
+
+#else /* !TIMESLICE_ATOMIC */
+
+static inline int atomic_or_(int *var, int val)
+{
+    int old = *var;
+    *var = old | val;
+    return old;
+}
+static inline int atomic_and_(int *var, int val)
+{
+    int old = *var;
+    *var = old & val;
+    return old;
+}
+
+#define ATOMIC_LOAD(var) (var)
+#define ATOMIC_STORE(var, val) ((var) = (val))
+#define ATOMIC_OR(var, val) atomic_or_((int *)&(var), (int)(val))
+#define ATOMIC_AND(var, val) atomic_and_((int *)&(var), (int)(val))
+#define ATOMIC_ADD(var, val) ((var) += (val))
+#define ATOMIC_SUB(var, val) ((var) -= (val))
+#define ATOMIC_CAS(var, exp, val) ((var) == (exp) ? ((var) = (val), 1) : ((exp) = (var), 0))
+#define ATOMIC_FENCE() ((void)0)
+#define ATOMIC_LOCAL
+
+#endif /* TIMESLICE_ATOMIC */
+
+#endif /* __ATOMIC_H__ */
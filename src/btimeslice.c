@@ -0,0 +1,424 @@
+/*!
+ @file btimeslice.c
+ @brief Cooperative timeslice scheduler implementation with tasks grouped by period.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "btimeslice.h"
+
+#define BIT(ctx, bit) ((ctx)->stat & (bit))
+#define SET(ctx, bit) ((ctx)->stat |= (bit))
+#define CLR(ctx, bit) ((ctx)->stat &= ~(bit))
+#define HAS(ctx, bit) (((ctx)->stat & (bit)) == (bit))
+#define NOT(ctx, bit) (((ctx)->stat & (bit)) != (bit))
+
+#define BTIMESLICE_HASH (1 << BTIMESLICE_BITS)
+
+/*!
+ @brief timeslice flags
+*/
+enum
+{
+    BTIMESLICE_CTRL = 0x000F, //!< Register for control
+    BTIMESLICE_EXEC = 1 << 0, //!< Bit that the task needs to execute
+    BTIMESLICE_JOIN = 1 << 1, //!< Bit which the task has been joined
+    BTIMESLICE_STAT = 0x00F0, //!< Register for status
+    BTIMESLICE_LOCK = 1 << 4, //!< Bit that the task has been locked
+    BTIMESLICE_TYPE = 0x0F00, //!< Register for type
+    BTIMESLICE_CRON = 1 << 8, //!< Bit for the cron task
+    BTIMESLICE_ONCE = 1 << 9, //!< Bit for the once task
+};
+
+static btimeslice_bucket_s pool[BTIMESLICE_BUCKET];
+static btimeslice_sched_s local[1];
+
+/* the default scheduler is initialized on first use */
+static btimeslice_sched_s *btimeslice_local_(void)
+{
+    if (local->live->next == 0)
+    {
+        btimeslice_sched_init(local, pool, BTIMESLICE_BUCKET);
+    }
+    return local;
+}
+
+void btimeslice_sched_init(btimeslice_sched_s *sched, btimeslice_bucket_s *bucket, size_t count)
+{
+    for (unsigned int i = 0; i != BTIMESLICE_HASH; ++i)
+    {
+        list_init(sched->hash + i);
+    }
+    list_init(sched->live);
+    list_init(sched->solo);
+    list_init(sched->idle);
+    list_init(sched->fired);
+    list_init(sched->ready);
+    for (size_t i = 0; i != count; ++i)
+    {
+        list_init(bucket[i].live);
+        list_init(bucket[i].task);
+        list_init(bucket[i].ready);
+        list_add(sched->idle, bucket[i].node);
+    }
+    sched->cursor = 0;
+    sched->ctx = 0;
+    sched->counter = 0;
+    sched->buckets = 0;
+    sched->now = 0;
+    sched->stagger = 0;
+}
+
+btimeslice_s *btimeslice_self_r(const btimeslice_sched_s *sched)
+{
+    return sched->ctx;
+}
+
+void btimeslice_set_stagger_r(btimeslice_sched_s *sched, int stagger)
+{
+    sched->stagger = stagger;
+}
+void btimeslice_set_stagger(int stagger)
+{
+    btimeslice_set_stagger_r(btimeslice_local_(), stagger);
+}
+
+/* the buckets of a slice fire on the ticks of the same residue, which keys them with the slice */
+static inline list_s *btimeslice_hash_(btimeslice_sched_s *sched, size_t slice, size_t expire)
+{
+    size_t key = slice * 0x9E3779B9U ^ expire % slice;
+    return sched->hash + ((key ^ key >> BTIMESLICE_BITS) & (BTIMESLICE_HASH - 1));
+}
+
+static btimeslice_bucket_s *btimeslice_find_(btimeslice_sched_s *sched, size_t slice, size_t expire)
+{
+    btimeslice_bucket_s *ctx;
+    list_s *head = btimeslice_hash_(sched, slice, expire), *node;
+    list_foreach(node, head)
+    {
+        ctx = list_entry(node, btimeslice_bucket_s, node);
+        if (ctx->slice == slice && ctx->expire == expire)
+        {
+            return ctx;
+        }
+    }
+    if (list_null(sched->idle))
+    {
+        return 0;
+    }
+    ctx = list_entry(sched->idle->next, btimeslice_bucket_s, node);
+    list_del(ctx->node);
+    list_add(head, ctx->node);
+    list_add(sched->live, ctx->live);
+    ctx->count = 0;
+    ctx->slice = slice;
+    ctx->expire = expire;
+    ++sched->buckets;
+    return ctx;
+}
+
+/* weigh the phases spread over the slice from the full slice down, and take the first least loaded */
+static size_t btimeslice_stagger_(const btimeslice_sched_s *sched, size_t slice)
+{
+    size_t timer = slice, least = ~(size_t)0;
+    size_t n = slice < BTIMESLICE_STAGGER ? slice : BTIMESLICE_STAGGER;
+    for (size_t i = 0; i != n && least; ++i)
+    {
+        size_t load = 0;
+        size_t phase = slice - i * slice / n;
+        const list_s *node;
+        list_foreach(node, sched->live)
+        {
+            const btimeslice_bucket_s *group = list_entry(node, btimeslice_bucket_s, live);
+            size_t delay = group->expire - sched->now;
+            if (phase >= delay && (phase - delay) % group->slice == 0)
+            {
+                load += group->count;
+            }
+        }
+        if (load < least)
+        {
+            least = load;
+            timer = phase;
+        }
+    }
+    return timer;
+}
+
+/* put a joined task into the bucket of its slice and phase, or count it down on its own */
+static void btimeslice_arm_(btimeslice_sched_s *sched, btimeslice_s *ctx, size_t timer)
+{
+    if (timer == 0)
+    {
+        return;
+    }
+    ctx->expire = sched->now + timer;
+    if (BIT(ctx, BTIMESLICE_CRON) && timer <= ctx->slice)
+    {
+        ctx->bucket = btimeslice_find_(sched, ctx->slice, ctx->expire);
+        if (ctx->bucket)
+        {
+            list_add(ctx->bucket->task, ctx->node);
+            ++ctx->bucket->count;
+            return;
+        }
+    }
+    list_add(sched->solo, ctx->node);
+}
+
+static inline void btimeslice_release_(btimeslice_sched_s *sched, btimeslice_s *ctx)
+{
+    if (NOT(ctx, BTIMESLICE_EXEC))
+    {
+        SET(ctx, BTIMESLICE_EXEC);
+        list_add(sched->ready, ctx->ready);
+    }
+}
+
+static void btimeslice_disarm_(btimeslice_sched_s *sched, btimeslice_s *ctx)
+{
+    btimeslice_bucket_s *group = ctx->bucket;
+    if (sched->cursor == ctx->node)
+    {
+        sched->cursor = ctx->node->next;
+    }
+    /* a member that leaves a fired bucket before its turn is released on its own */
+    if (group && list_used(group->ready) && ctx->expire != group->expire)
+    {
+        btimeslice_release_(sched, ctx);
+    }
+    list_del(ctx->node);
+    ctx->bucket = 0;
+    if (group && --group->count == 0)
+    {
+        list_del(group->node);
+        list_del(group->live);
+        list_del(group->ready);
+        list_add(sched->idle, group->node);
+        --sched->buckets;
+    }
+}
+
+void btimeslice_tick_r(btimeslice_sched_s *sched)
+{
+    btimeslice_s *ctx;
+    list_s *node, *next;
+    size_t now = ++sched->now;
+    list_foreach(node, sched->live)
+    {
+        btimeslice_bucket_s *group = list_entry(node, btimeslice_bucket_s, live);
+        if (group->expire == now)
+        {
+            group->expire += group->slice;
+            if (list_null(group->ready))
+            {
+                list_add(sched->fired, group->ready);
+            }
+        }
+    }
+    list_forsafe(node, next, sched->solo)
+    {
+        ctx = list_entry(node, btimeslice_s, node);
+        if (ctx->expire == now)
+        {
+            btimeslice_release_(sched, ctx);
+            /* a cron task joins the bucket of its slice after its first release */
+            btimeslice_disarm_(sched, ctx);
+            if (BIT(ctx, BTIMESLICE_CRON))
+            {
+                btimeslice_arm_(sched, ctx, ctx->slice);
+            }
+        }
+    }
+}
+
+/* the members that joined after the bucket fired have the expiry of the bucket, and wait for it */
+static void btimeslice_burst_(btimeslice_sched_s *sched, btimeslice_bucket_s *group)
+{
+    for (sched->cursor = group->task->next; sched->cursor != group->task;)
+    {
+        btimeslice_s *ctx = list_entry(sched->cursor, btimeslice_s, node);
+        sched->cursor = sched->cursor->next;
+        if (ctx->expire != group->expire)
+        {
+            ctx->expire = group->expire;
+            sched->ctx = ctx;
+            ctx->exec(ctx->argv);
+        }
+    }
+    list_del(group->ready);
+    sched->cursor = 0;
+}
+
+void btimeslice_exec_r(btimeslice_sched_s *sched)
+{
+    while (list_used(sched->fired))
+    {
+        btimeslice_burst_(sched, list_entry(sched->fired->next, btimeslice_bucket_s, ready));
+    }
+    while (list_used(sched->ready))
+    {
+        sched->ctx = list_entry(sched->ready->next, btimeslice_s, ready);
+        list_del(sched->ctx->ready);
+        CLR(sched->ctx, BTIMESLICE_EXEC);
+        sched->ctx->exec(sched->ctx->argv);
+        if (BIT(sched->ctx, BTIMESLICE_ONCE))
+        {
+            btimeslice_drop_r(sched, sched->ctx);
+        }
+    }
+}
+
+void btimeslice_tick(void)
+{
+    btimeslice_tick_r(btimeslice_local_());
+}
+
+void btimeslice_exec(void)
+{
+    btimeslice_exec_r(btimeslice_local_());
+}
+
+void btimeslice_cron(btimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice)
+{
+    list_init(ctx->node);
+    list_init(ctx->ready);
+    ctx->bucket = 0;
+    ctx->slice = slice;
+    ctx->timer = slice;
+    ctx->expire = 0;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = BTIMESLICE_CRON;
+}
+
+void btimeslice_once(btimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay)
+{
+    list_init(ctx->node);
+    list_init(ctx->ready);
+    ctx->bucket = 0;
+    ctx->slice = delay;
+    ctx->timer = delay;
+    ctx->expire = 0;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = BTIMESLICE_ONCE;
+}
+
+void btimeslice_set_exec(btimeslice_s *ctx, void (*exec)(void *))
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->exec = exec;
+}
+void btimeslice_set_argv(btimeslice_s *ctx, void *argv)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->argv = argv;
+}
+void btimeslice_set_timer_r(btimeslice_sched_s *sched, btimeslice_s *ctx, size_t timer)
+{
+    ctx = ctx ? ctx : sched->ctx;
+    ctx->timer = timer;
+    if (HAS(ctx, BTIMESLICE_JOIN))
+    {
+        btimeslice_disarm_(sched, ctx);
+        btimeslice_arm_(sched, ctx, timer);
+    }
+}
+void btimeslice_set_timer(btimeslice_s *ctx, size_t timer)
+{
+    btimeslice_set_timer_r(btimeslice_local_(), ctx, timer);
+}
+void btimeslice_set_slice_r(btimeslice_sched_s *sched, btimeslice_s *ctx, size_t slice)
+{
+    ctx = ctx ? ctx : sched->ctx;
+    if (HAS(ctx, BTIMESLICE_JOIN) && list_used(ctx->node))
+    {
+        /* keep the next release, and move to the bucket of the new slice from there */
+        size_t timer = btimeslice_timer_r(sched, ctx);
+        btimeslice_disarm_(sched, ctx);
+        ctx->slice = slice;
+        btimeslice_arm_(sched, ctx, timer);
+    }
+    ctx->slice = slice;
+}
+void btimeslice_set_slice(btimeslice_s *ctx, size_t slice)
+{
+    btimeslice_set_slice_r(btimeslice_local_(), ctx, slice);
+}
+
+void btimeslice_join_r(btimeslice_sched_s *sched, btimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : sched->ctx;
+    if (NOT(ctx, BTIMESLICE_JOIN))
+    {
+        SET(ctx, BTIMESLICE_JOIN);
+        if (sched->stagger && BIT(ctx, BTIMESLICE_CRON) && ctx->timer && ctx->timer == ctx->slice)
+        {
+            ctx->timer = btimeslice_stagger_(sched, ctx->slice);
+        }
+        btimeslice_arm_(sched, ctx, ctx->timer);
+        ++sched->counter;
+    }
+}
+void btimeslice_join(btimeslice_s *ctx)
+{
+    btimeslice_join_r(btimeslice_local_(), ctx);
+}
+
+void btimeslice_drop_r(btimeslice_sched_s *sched, btimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : sched->ctx;
+    if (HAS(ctx, BTIMESLICE_JOIN))
+    {
+        ctx->timer = btimeslice_timer_r(sched, ctx);
+        btimeslice_disarm_(sched, ctx);
+        list_del(ctx->ready);
+        CLR(ctx, BTIMESLICE_CTRL);
+        --sched->counter;
+    }
+}
+void btimeslice_drop(btimeslice_s *ctx)
+{
+    btimeslice_drop_r(btimeslice_local_(), ctx);
+}
+
+int btimeslice_exist(const btimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return HAS(ctx, BTIMESLICE_JOIN);
+}
+
+size_t btimeslice_timer_r(const btimeslice_sched_s *sched, const btimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : sched->ctx;
+    if (NOT(ctx, BTIMESLICE_JOIN))
+    {
+        return ctx->timer;
+    }
+    if (list_null(ctx->node))
+    {
+        return 0;
+    }
+    return (ctx->bucket ? ctx->bucket->expire : ctx->expire) - sched->now;
+}
+size_t btimeslice_timer(const btimeslice_s *ctx)
+{
+    return btimeslice_timer_r(local, ctx);
+}
+size_t btimeslice_slice(const btimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return ctx->slice;
+}
+size_t btimeslice_count(void)
+{
+    return local->counter;
+}
+size_t btimeslice_count_r(const btimeslice_sched_s *sched)
+{
+    return sched->counter;
+}
+size_t btimeslice_bucket_r(const btimeslice_sched_s *sched)
+{
+    return sched->buckets;
+}
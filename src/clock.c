@@ -0,0 +1,32 @@
+/*!
+ @file clock.c
+ @brief Monotonic clock used by timeslice to measure the executions.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else /* C */
+#include <time.h>
+#endif /* __unix__ */
+#include "clock.h"
+
+uint64_t clock_ns(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#elif defined(_WIN32)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (uint64_t)count.QuadPart / (uint64_t)freq.QuadPart * 1000000000U +
+           (uint64_t)count.QuadPart % (uint64_t)freq.QuadPart * 1000000000U / (uint64_t)freq.QuadPart;
+#else /* C */
+    return (uint64_t)clock() * (1000000000U / CLOCKS_PER_SEC);
+#endif /* __unix__ */
+}
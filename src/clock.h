@@ -0,0 +1,18 @@
+/*!
+ @file clock.h
+ @brief Monotonic clock used by timeslice to measure the executions.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __CLOCK_H__
+#define __CLOCK_H__
+
+#include <stdint.h>
+
+/*!
+ @brief Get the time of a monotonic clock
+ @return uint64_t The time in nanoseconds
+*/
+uint64_t clock_ns(void);
+
+#endif /* __CLOCK_H__ */
@@ -0,0 +1,182 @@
+/*!
+ @file ctimeslice.c
+ @brief Cooperative timeslice scheduler implementation with compact tasks in an array.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "ctimeslice.h"
+
+#define BIT(ctx, bit) ((ctx)->link & (bit))
+#define SET(ctx, bit) ((ctx)->link = (ctimeslice_t)((ctx)->link | (bit)))
+#define CLR(ctx, bit) ((ctx)->link = (ctimeslice_t)((ctx)->link & ~(bit)))
+#define HAS(ctx, bit) (((ctx)->link & (bit)) == (bit))
+#define NOT(ctx, bit) (((ctx)->link & (bit)) != (bit))
+
+/* the flags are in the top bits of the link, beyond the range of an enumeration */
+#define CTIMESLICE_EXEC ((ctimeslice_t)1 << (CTIMESLICE_WIDTH - 1)) //!< Bit that the task needs to execute
+#define CTIMESLICE_JOIN ((ctimeslice_t)1 << (CTIMESLICE_WIDTH - 2)) //!< Bit which the task has been joined
+#define CTIMESLICE_WAIT ((ctimeslice_t)1 << (CTIMESLICE_WIDTH - 3)) //!< Bit that the task is in the ready queue
+#define CTIMESLICE_ONCE ((ctimeslice_t)1 << (CTIMESLICE_WIDTH - 4)) //!< Bit for the once task
+#define CTIMESLICE_NONE ((ctimeslice_t)(CTIMESLICE_ONCE - 1)) //!< Register for the index of the next ready task
+#define CTIMESLICE_FLAG ((ctimeslice_t)~CTIMESLICE_NONE) //!< Register for the flags
+
+static inline size_t ctimeslice_clamp_(size_t value)
+{
+    return value < CTIMESLICE_MAX ? value : CTIMESLICE_MAX;
+}
+
+void ctimeslice_sched_init(ctimeslice_sched_s *sched, ctimeslice_s *task, ctimeslice_call_s *call, size_t count)
+{
+    sched->task = task;
+    sched->call = call;
+    sched->count = count;
+    sched->counter = 0;
+    sched->head = CTIMESLICE_NONE;
+    sched->tail = CTIMESLICE_NONE;
+    sched->ctx = CTIMESLICE_NONE;
+    for (size_t i = 0; i != count; ++i)
+    {
+        task[i].timer = 0;
+        task[i].slice = 0;
+        task[i].link = CTIMESLICE_NONE;
+        call[i].exec = 0;
+        call[i].argv = 0;
+    }
+}
+
+size_t ctimeslice_self_r(const ctimeslice_sched_s *sched)
+{
+    return sched->ctx;
+}
+
+void ctimeslice_tick_r(ctimeslice_sched_s *sched)
+{
+    ctimeslice_s *ctx = sched->task;
+    ctimeslice_s *end = ctx + sched->count;
+    for (; ctx != end; ++ctx)
+    {
+        if (!BIT(ctx, CTIMESLICE_JOIN) || !ctx->timer || --ctx->timer)
+        {
+            continue;
+        }
+        SET(ctx, CTIMESLICE_EXEC);
+        ctx->timer = BIT(ctx, CTIMESLICE_ONCE) ? 0 : ctx->slice;
+        if (NOT(ctx, CTIMESLICE_WAIT))
+        {
+            /* append to the ready list, which is linked through the low bits of the link */
+            size_t id = (size_t)(ctx - sched->task);
+            ctx->link = (ctimeslice_t)((ctx->link & CTIMESLICE_FLAG) | CTIMESLICE_WAIT | CTIMESLICE_NONE);
+            if (sched->tail != CTIMESLICE_NONE)
+            {
+                ctimeslice_s *tail = sched->task + sched->tail;
+                tail->link = (ctimeslice_t)((tail->link & CTIMESLICE_FLAG) | (ctimeslice_t)id);
+            }
+            else
+            {
+                sched->head = id;
+            }
+            sched->tail = id;
+        }
+    }
+}
+
+void ctimeslice_exec_r(ctimeslice_sched_s *sched)
+{
+    ctimeslice_s *ctx;
+    while (sched->head != CTIMESLICE_NONE)
+    {
+        ctx = sched->task + sched->head;
+        sched->ctx = sched->head;
+        sched->head = ctx->link & CTIMESLICE_NONE;
+        if (sched->head == CTIMESLICE_NONE)
+        {
+            sched->tail = CTIMESLICE_NONE;
+        }
+        CLR(ctx, CTIMESLICE_WAIT);
+        if (HAS(ctx, CTIMESLICE_JOIN | CTIMESLICE_EXEC))
+        {
+            CLR(ctx, CTIMESLICE_EXEC);
+            sched->call[sched->ctx].exec(sched->call[sched->ctx].argv);
+            if (BIT(ctx, CTIMESLICE_ONCE))
+            {
+                ctimeslice_drop_r(sched, sched->ctx);
+            }
+        }
+    }
+}
+
+void ctimeslice_cron_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t slice)
+{
+    ctimeslice_s *ctx = sched->task + id;
+    ctx->slice = (ctimeslice_t)ctimeslice_clamp_(slice);
+    ctx->timer = ctx->slice;
+    ctx->link = CTIMESLICE_NONE;
+    sched->call[id].exec = exec;
+    sched->call[id].argv = argv;
+}
+
+void ctimeslice_once_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t delay)
+{
+    ctimeslice_s *ctx = sched->task + id;
+    ctx->slice = (ctimeslice_t)ctimeslice_clamp_(delay);
+    ctx->timer = ctx->slice;
+    ctx->link = CTIMESLICE_ONCE | CTIMESLICE_NONE;
+    sched->call[id].exec = exec;
+    sched->call[id].argv = argv;
+}
+
+void ctimeslice_set_exec_r(ctimeslice_sched_s *sched, size_t id, void (*exec)(void *))
+{
+    sched->call[id].exec = exec;
+}
+void ctimeslice_set_argv_r(ctimeslice_sched_s *sched, size_t id, void *argv)
+{
+    sched->call[id].argv = argv;
+}
+void ctimeslice_set_timer_r(ctimeslice_sched_s *sched, size_t id, size_t timer)
+{
+    sched->task[id].timer = (ctimeslice_t)ctimeslice_clamp_(timer);
+}
+void ctimeslice_set_slice_r(ctimeslice_sched_s *sched, size_t id, size_t slice)
+{
+    sched->task[id].slice = (ctimeslice_t)ctimeslice_clamp_(slice);
+}
+
+void ctimeslice_join_r(ctimeslice_sched_s *sched, size_t id)
+{
+    ctimeslice_s *ctx = sched->task + id;
+    if (NOT(ctx, CTIMESLICE_JOIN))
+    {
+        SET(ctx, CTIMESLICE_JOIN);
+        ++sched->counter;
+    }
+}
+
+void ctimeslice_drop_r(ctimeslice_sched_s *sched, size_t id)
+{
+    ctimeslice_s *ctx = sched->task + id;
+    if (HAS(ctx, CTIMESLICE_JOIN))
+    {
+        /* a queued task stays linked, and the exec skips it */
+        CLR(ctx, CTIMESLICE_JOIN | CTIMESLICE_EXEC);
+        --sched->counter;
+    }
+}
+
+int ctimeslice_exist_r(const ctimeslice_sched_s *sched, size_t id)
+{
+    return HAS(sched->task + id, CTIMESLICE_JOIN);
+}
+
+size_t ctimeslice_timer_r(const ctimeslice_sched_s *sched, size_t id)
+{
+    return sched->task[id].timer;
+}
+size_t ctimeslice_slice_r(const ctimeslice_sched_s *sched, size_t id)
+{
+    return sched->task[id].slice;
+}
+size_t ctimeslice_count_r(const ctimeslice_sched_s *sched)
+{
+    return sched->counter;
+}
@@ -0,0 +1,33 @@
+/*!
+ @file futex.c
+ @brief Blocking wait on a word used by timeslice to put an idle exec to sleep.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#endif /* __linux__ */
+#include "futex.h"
+
+void futex_wait(int *word, int val)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, 0, 0, 0);
+#else /* !__linux__ */
+    (void)word;
+    (void)val;
+#endif /* __linux__ */
+}
+
+void futex_wake(int *word)
+{
+#if defined(__linux__)
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+#else /* !__linux__ */
+    (void)word;
+#endif /* __linux__ */
+}
@@ -0,0 +1,24 @@
+/*!
+ @file futex.h
+ @brief Blocking wait on a word used by timeslice to put an idle exec to sleep.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __FUTEX_H__
+#define __FUTEX_H__
+
+/*!
+ @brief Sleep while the word still holds the expected value
+ @details It returns at once on the platforms without a futex, so the callers spin.
+ @param[in] word points to the word to wait on
+ @param[in] val The expected value of the word
+*/
+void futex_wait(int *word, int val);
+
+/*!
+ @brief Wake all the threads sleeping on the word
+ @param[in] word points to the word to wake
+*/
+void futex_wake(int *word);
+
+#endif /* __FUTEX_H__ */
@@ -0,0 +1,212 @@
+/*!
+ @file htimeslice.c
+ @brief Cooperative timeslice scheduler implementation based on absolute deadline.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "htimeslice.h"
+
+#define BIT(ctx, bit) ((ctx)->stat & (bit))
+#define SET(ctx, bit) ((ctx)->stat |= (bit))
+#define CLR(ctx, bit) ((ctx)->stat &= ~(bit))
+#define HAS(ctx, bit) (((ctx)->stat & (bit)) == (bit))
+#define NOT(ctx, bit) (((ctx)->stat & (bit)) != (bit))
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HTIMESLICE_LOAD(var) __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define HTIMESLICE_INCR(var) __atomic_add_fetch(&(var), 1, __ATOMIC_RELEASE)
+#else /* !__GNUC__ */
+#define HTIMESLICE_LOAD(var) (var)
+#define HTIMESLICE_INCR(var) (++(var))
+#endif /* __GNUC__ */
+
+/* the tick count wraps around, and a deadline within half of its range ahead is in the future */
+#define HTIMESLICE_HALF ((size_t)~(size_t)0 >> 1)
+
+/*!
+ @brief timeslice flags
+*/
+enum
+{
+    HTIMESLICE_CTRL = 0x000F, //!< Register for control
+    HTIMESLICE_EXEC = 1 << 0, //!< Bit that the task needs to execute
+    HTIMESLICE_JOIN = 1 << 1, //!< Bit which the task has been joined
+    HTIMESLICE_STAT = 0x00F0, //!< Register for status
+    HTIMESLICE_HEAP = 1 << 4, //!< Bit that the task is in the deadline heap
+    HTIMESLICE_TYPE = 0x0F00, //!< Register for type
+    HTIMESLICE_CRON = 1 << 8, //!< Bit for the cron task
+    HTIMESLICE_ONCE = 1 << 9, //!< Bit for the once task
+};
+
+static struct
+{
+    pheap_s *root;
+    htimeslice_s *ctx;
+    size_t counter;
+    volatile size_t now;
+} local[1] = {{0, 0, 0, 0}};
+
+static int htimeslice_cmp_(const pheap_s *lhs, const pheap_s *rhs)
+{
+    size_t diff = pheap_entry(lhs, htimeslice_s const, node)->due - pheap_entry(rhs, htimeslice_s const, node)->due;
+    if (diff)
+    {
+        return diff > HTIMESLICE_HALF ? -1 : 1;
+    }
+    return 0;
+}
+
+static inline void htimeslice_arm_(htimeslice_s *ctx, size_t timer, size_t now)
+{
+    if (BIT(ctx, HTIMESLICE_HEAP))
+    {
+        local->root = pheap_del(local->root, ctx->node, htimeslice_cmp_);
+        CLR(ctx, HTIMESLICE_HEAP);
+    }
+    if (timer)
+    {
+        ctx->due = now + timer;
+        local->root = pheap_add(local->root, ctx->node, htimeslice_cmp_);
+        SET(ctx, HTIMESLICE_HEAP);
+    }
+}
+
+/* the ticks until the deadline, or 0 once it has passed */
+static inline size_t htimeslice_left_(const htimeslice_s *ctx, size_t now)
+{
+    size_t left = ctx->due - now;
+    return left <= HTIMESLICE_HALF ? left : 0;
+}
+
+void htimeslice_tick(void)
+{
+    HTIMESLICE_INCR(local->now);
+}
+
+void htimeslice_exec(void)
+{
+    size_t now = HTIMESLICE_LOAD(local->now);
+    while (local->root)
+    {
+        local->ctx = pheap_entry(local->root, htimeslice_s, node);
+        if (htimeslice_left_(local->ctx, now))
+        {
+            break;
+        }
+        local->root = pheap_del(local->root, local->root, htimeslice_cmp_);
+        if (BIT(local->ctx, HTIMESLICE_CRON) && local->ctx->slice)
+        {
+            /* coalesce the periods that have been missed into one execution */
+            local->ctx->due += local->ctx->slice * ((now - local->ctx->due) / local->ctx->slice + 1);
+            local->root = pheap_add(local->root, local->ctx->node, htimeslice_cmp_);
+        }
+        else
+        {
+            CLR(local->ctx, HTIMESLICE_HEAP);
+        }
+        local->ctx->exec(local->ctx->argv);
+        if (BIT(local->ctx, HTIMESLICE_ONCE))
+        {
+            htimeslice_drop(local->ctx);
+        }
+    }
+}
+
+void htimeslice_cron(htimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice)
+{
+    pheap_init(ctx->node);
+    ctx->due = 0;
+    ctx->slice = slice;
+    ctx->timer = slice;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = HTIMESLICE_CRON;
+}
+
+void htimeslice_once(htimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay)
+{
+    pheap_init(ctx->node);
+    ctx->due = 0;
+    ctx->slice = delay;
+    ctx->timer = delay;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = HTIMESLICE_ONCE;
+}
+
+void htimeslice_set_exec(htimeslice_s *ctx, void (*exec)(void *))
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->exec = exec;
+}
+void htimeslice_set_argv(htimeslice_s *ctx, void *argv)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->argv = argv;
+}
+void htimeslice_set_timer(htimeslice_s *ctx, size_t timer)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->timer = timer;
+    if (HAS(ctx, HTIMESLICE_JOIN))
+    {
+        htimeslice_arm_(ctx, timer, HTIMESLICE_LOAD(local->now));
+    }
+}
+void htimeslice_set_slice(htimeslice_s *ctx, size_t slice)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->slice = slice;
+}
+
+void htimeslice_join(htimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (NOT(ctx, HTIMESLICE_JOIN))
+    {
+        SET(ctx, HTIMESLICE_JOIN);
+        htimeslice_arm_(ctx, ctx->timer, HTIMESLICE_LOAD(local->now));
+        ++local->counter;
+    }
+}
+
+void htimeslice_drop(htimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (HAS(ctx, HTIMESLICE_JOIN))
+    {
+        ctx->timer = htimeslice_timer(ctx);
+        htimeslice_arm_(ctx, 0, 0);
+        CLR(ctx, HTIMESLICE_CTRL);
+        --local->counter;
+    }
+}
+
+int htimeslice_exist(const htimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return HAS(ctx, HTIMESLICE_JOIN);
+}
+
+size_t htimeslice_timer(const htimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (NOT(ctx, HTIMESLICE_JOIN))
+    {
+        return ctx->timer;
+    }
+    return BIT(ctx, HTIMESLICE_HEAP) ? htimeslice_left_(ctx, HTIMESLICE_LOAD(local->now)) : 0;
+}
+size_t htimeslice_slice(const htimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return ctx->slice;
+}
+size_t htimeslice_count(void)
+{
+    return local->counter;
+}
+size_t htimeslice_now(void)
+{
+    return HTIMESLICE_LOAD(local->now);
+}
@@ -0,0 +1,116 @@
+/*!
+ @file iowait.c
+ @brief Readiness wait on file descriptors used by timeslice to wake the io tasks.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <stdint.h>
+#endif /* __linux__ */
+#include "iowait.h"
+
+#define IOWAIT_BATCH 16
+
+int iowait_open(int *kick)
+{
+#if defined(__linux__)
+    struct epoll_event event;
+    int wait = epoll_create1(EPOLL_CLOEXEC);
+    if (wait < 0)
+    {
+        return -1;
+    }
+    *kick = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    event.events = EPOLLIN;
+    event.data.ptr = 0;
+    if (*kick < 0 || epoll_ctl(wait, EPOLL_CTL_ADD, *kick, &event) < 0)
+    {
+        if (*kick >= 0)
+        {
+            close(*kick);
+        }
+        close(wait);
+        return -1;
+    }
+    return wait;
+#else /* !__linux__ */
+    (void)kick;
+    return -1;
+#endif /* __linux__ */
+}
+
+int iowait_add(int wait, int fd, unsigned int events, void *data)
+{
+#if defined(__linux__)
+    struct epoll_event event;
+    event.events = events;
+    event.data.ptr = data;
+    return epoll_ctl(wait, EPOLL_CTL_ADD, fd, &event) < 0 ? -1 : 0;
+#else /* !__linux__ */
+    (void)wait;
+    (void)fd;
+    (void)events;
+    (void)data;
+    return -1;
+#endif /* __linux__ */
+}
+
+void iowait_del(int wait, int fd)
+{
+#if defined(__linux__)
+    struct epoll_event event = {0, {0}};
+    epoll_ctl(wait, EPOLL_CTL_DEL, fd, &event);
+#else /* !__linux__ */
+    (void)wait;
+    (void)fd;
+#endif /* __linux__ */
+}
+
+int iowait_wait(int wait, int kick, void **data, unsigned int *events, int count, int timeout)
+{
+#if defined(__linux__)
+    struct epoll_event event[IOWAIT_BATCH];
+    int n = epoll_wait(wait, event, count < IOWAIT_BATCH ? count : IOWAIT_BATCH, timeout);
+    int ready = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        if (event[i].data.ptr)
+        {
+            data[ready] = event[i].data.ptr;
+            events[ready] = event[i].events;
+            ++ready;
+        }
+        else
+        {
+            /* the kick descriptor is drained, the value is of no use */
+            uint64_t value;
+            ssize_t size = read(kick, &value, sizeof(value));
+            (void)size;
+        }
+    }
+    return ready;
+#else /* !__linux__ */
+    (void)wait;
+    (void)kick;
+    (void)data;
+    (void)events;
+    (void)count;
+    (void)timeout;
+    return 0;
+#endif /* __linux__ */
+}
+
+void iowait_kick(int kick)
+{
+#if defined(__linux__)
+    uint64_t value = 1;
+    ssize_t size = write(kick, &value, sizeof(value));
+    (void)size;
+#else /* !__linux__ */
+    (void)kick;
+#endif /* __linux__ */
+}
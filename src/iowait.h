@@ -0,0 +1,55 @@
+/*!
+ @file iowait.h
+ @brief Readiness wait on file descriptors used by timeslice to wake the io tasks.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __IOWAIT_H__
+#define __IOWAIT_H__
+
+/*!
+ @brief Open a wait instance with a kick descriptor registered to it
+ @details It fails on the platforms without epoll.
+ @param[out] kick points to the descriptor that iowait_kick() writes to
+ @return int The wait instance, or -1 on failure
+*/
+int iowait_open(int *kick);
+
+/*!
+ @brief Register a file descriptor with a wait instance
+ @param[in] wait The wait instance
+ @param[in] fd The file descriptor
+ @param[in] events The interest mask, in the values of poll
+ @param[in] data The pointer that the wait reports
+ @return int 0 on success, -1 on failure
+*/
+int iowait_add(int wait, int fd, unsigned int events, void *data);
+
+/*!
+ @brief Unregister a file descriptor from a wait instance
+ @param[in] wait The wait instance
+ @param[in] fd The file descriptor
+*/
+void iowait_del(int wait, int fd);
+
+/*!
+ @brief Wait for the registered file descriptors to become ready
+ @details The kick descriptor is drained and not reported.
+ @param[in] wait The wait instance
+ @param[in] kick The kick descriptor of the wait instance
+ @param[out] data The pointers of the ready file descriptors
+ @param[out] events The ready events of the file descriptors
+ @param[in] count The capacity of the arrays
+ @param[in] timeout The timeout in milliseconds, -1 to wait without a timeout
+ @return int The count of ready file descriptors
+*/
+int iowait_wait(int wait, int kick, void **data, unsigned int *events, int count, int timeout);
+
+/*!
+ @brief Wake the thread that waits on the wait instance of the kick descriptor
+ @details It is safe to call from a signal handler.
+ @param[in] kick The kick descriptor
+*/
+void iowait_kick(int kick);
+
+#endif /* __IOWAIT_H__ */
@@ -0,0 +1,94 @@
+/*!
+ @file pheap.c
+ @brief Intrusive pairing heap implementation.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "pheap.h"
+
+pheap_s *pheap_meld(pheap_s *lhs, pheap_s *rhs, pheap_cmp_f cmp)
+{
+    pheap_s *tmp;
+    if (!lhs)
+    {
+        return rhs;
+    }
+    if (!rhs)
+    {
+        return lhs;
+    }
+    if (cmp(rhs, lhs) < 0)
+    {
+        tmp = lhs;
+        lhs = rhs;
+        rhs = tmp;
+    }
+    rhs->next = lhs->child;
+    if (lhs->child)
+    {
+        lhs->child->prev = rhs;
+    }
+    rhs->prev = lhs;
+    lhs->child = rhs;
+    lhs->next = lhs->prev = 0;
+    return lhs;
+}
+
+pheap_s *pheap_pair(pheap_s *node, pheap_cmp_f cmp)
+{
+    pheap_s *root = 0, *next, *pair;
+    /* first pass: meld pairs from left to right, stacking them in reverse */
+    while (node)
+    {
+        next = node->next;
+        pair = 0;
+        if (next)
+        {
+            pair = next->next;
+            next->next = next->prev = 0;
+        }
+        node->next = node->prev = 0;
+        node = pheap_meld(node, next, cmp);
+        node->next = root;
+        root = node;
+        node = pair;
+    }
+    /* second pass: meld the stacked heaps from right to left */
+    for (node = 0; root; root = next)
+    {
+        next = root->next;
+        root->next = 0;
+        node = pheap_meld(node, root, cmp);
+    }
+    return node;
+}
+
+pheap_s *pheap_add(pheap_s *root, pheap_s *node, pheap_cmp_f cmp)
+{
+    pheap_init(node);
+    return pheap_meld(root, node, cmp);
+}
+
+pheap_s *pheap_del(pheap_s *root, pheap_s *node, pheap_cmp_f cmp)
+{
+    pheap_s *heap = pheap_pair(node->child, cmp);
+    if (node == root)
+    {
+        pheap_init(node);
+        return heap;
+    }
+    if (node->prev->child == node)
+    {
+        node->prev->child = node->next;
+    }
+    else
+    {
+        node->prev->next = node->next;
+    }
+    if (node->next)
+    {
+        node->next->prev = node->prev;
+    }
+    pheap_init(node);
+    return pheap_meld(root, heap, cmp);
+}
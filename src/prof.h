@@ -0,0 +1,39 @@
+/*!
+ @file prof.h
+ @brief Execution profile helpers shared by the timeslice schedulers.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#ifndef __PROF_H__
+#define __PROF_H__
+
+#include "timeslice_prof.h"
+#include "clock.h"
+
+static inline void prof_reset(timeslice_prof_s *prof)
+{
+    prof->count = 0;
+    prof->missed = 0;
+    prof->run_min = UINT64_MAX;
+    prof->run_max = 0;
+    prof->run_sum = 0;
+    prof->lat_min = UINT64_MAX;
+    prof->lat_max = 0;
+    prof->lat_sum = 0;
+}
+
+/* it is only called by the exec, after the execution function returned */
+static inline void prof_record(timeslice_prof_s *prof, uint64_t release, uint64_t start, uint64_t end)
+{
+    uint64_t run = end - start;
+    uint64_t lat = start - release;
+    ++prof->count;
+    prof->run_sum += run;
+    prof->run_min = run < prof->run_min ? run : prof->run_min;
+    prof->run_max = run > prof->run_max ? run : prof->run_max;
+    prof->lat_sum += lat;
+    prof->lat_min = lat < prof->lat_min ? lat : prof->lat_min;
+    prof->lat_max = lat > prof->lat_max ? lat : prof->lat_max;
+}
+
+#endif /* __PROF_H__ */
@@ -5,6 +5,13 @@
 */
 
 #include "stimeslice.h"
+#include "atomic.h"
+#if defined(TIMESLICE_PROFILE)
+#include "prof.h"
+#endif /* TIMESLICE_PROFILE */
+#if defined(TIMESLICE_HIST)
+#include "clock.h"
+#endif /* TIMESLICE_HIST */
 
 #define BIT(ctx, bit) ((ctx)->stat & (bit))
 #define SET(ctx, bit) ((ctx)->stat |= (bit))
@@ -22,145 +29,289 @@ enum
     STIMESLICE_JOIN = 1 << 1, //!< Bit which the task has been joined
     STIMESLICE_STAT = 0x00F0, //!< Register for status
     STIMESLICE_LOCK = 1 << 4, //!< Bit that the task has been locked
+    STIMESLICE_WAIT = 1 << 5, //!< Bit that the task is in the ready queue
     STIMESLICE_TYPE = 0x0F00, //!< Register for type
     STIMESLICE_CRON = 1 << 8, //!< Bit for the cron task
     STIMESLICE_ONCE = 1 << 9, //!< Bit for the once task
 };
 
-static struct
-{
-    slist_s running[1];
-    stimeslice_s *ctx;
-    size_t counter;
-} local[1] = {{
+static stimeslice_sched_s local[1] = {{
     {{
         {{local->running->head}},
         local->running->head,
     }},
+    {{
+        {{local->ready->head}},
+        local->ready->head,
+    }},
+    0,
+#if defined(TIMESLICE_HIST)
     0,
+#endif /* TIMESLICE_HIST */
     0,
 }};
 
-void stimeslice_tick(void)
+/* the task whose function is executing on this thread, which a null task refers to */
+static ATOMIC_LOCAL stimeslice_s *stimeslice_current_;
+
+void stimeslice_sched_init(stimeslice_sched_s *sched)
+{
+    slist_init(sched->running->head);
+    sched->running->tail = sched->running->head;
+    slist_init(sched->ready->head);
+    sched->ready->tail = sched->ready->head;
+    sched->ctx = 0;
+#if defined(TIMESLICE_HIST)
+    sched->hist = 0;
+#endif /* TIMESLICE_HIST */
+    sched->counter = 0;
+}
+
+stimeslice_s *stimeslice_self_r(const stimeslice_sched_s *sched)
+{
+    return sched->ctx;
+}
+
+void stimeslice_tick_r(stimeslice_sched_s *sched)
 {
     stimeslice_s *ctx;
     slist_u *node, *prev;
-    slist_forsafe(node, prev, local->running)
+    slist_forsafe(node, prev, sched->running)
     {
         ctx = slist_entry(node, stimeslice_s, node);
+        if (NOT(ctx, STIMESLICE_JOIN))
+        {
+            slist_del(sched->running, prev);
+            continue;
+        }
         if (ctx->timer && --ctx->timer == 0)
         {
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+            if (!BIT(ctx, STIMESLICE_EXEC))
+            {
+                ctx->release = clock_ns();
+            }
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+            if (BIT(ctx, STIMESLICE_EXEC))
+            {
+                ++ctx->prof->missed;
+            }
+#endif /* TIMESLICE_PROFILE */
             SET(ctx, STIMESLICE_EXEC);
             ctx->timer = ctx->slice;
+            if (NOT(ctx, STIMESLICE_WAIT))
+            {
+                SET(ctx, STIMESLICE_WAIT);
+                slist_add(sched->ready, ctx->ready);
+            }
         }
     }
 }
 
-void stimeslice_exec(void)
+void stimeslice_exec_r(stimeslice_sched_s *sched)
 {
-    slist_u *node, *prev;
-    slist_forsafe(node, prev, local->running)
+    stimeslice_s *ctx;
+    while (!slist_none(sched->ready))
     {
-        local->ctx = slist_entry(node, stimeslice_s, node);
-        if (NOT(local->ctx, STIMESLICE_JOIN))
+        ctx = slist_entry(sched->ready->head->next, stimeslice_s, ready);
+        slist_del(sched->ready, sched->ready->head);
+        CLR(ctx, STIMESLICE_WAIT);
+        if (HAS(ctx, STIMESLICE_JOIN | STIMESLICE_EXEC))
         {
-            slist_del(local->running, prev);
-            continue;
-        }
-        if (BIT(local->ctx, STIMESLICE_EXEC))
-        {
-            CLR(local->ctx, STIMESLICE_EXEC);
-            local->ctx->exec(local->ctx->argv);
-            if (BIT(local->ctx, STIMESLICE_ONCE))
+            stimeslice_s *last = stimeslice_current_;
+            stimeslice_current_ = ctx;
+            sched->ctx = ctx;
+            CLR(sched->ctx, STIMESLICE_EXEC);
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+            {
+                uint64_t start = clock_ns();
+#if defined(TIMESLICE_HIST)
+                if (sched->hist)
+                {
+                    timeslice_hist_add(sched->hist, start - ctx->release);
+                }
+#endif /* TIMESLICE_HIST */
+                sched->ctx->exec(sched->ctx->argv);
+#if defined(TIMESLICE_PROFILE)
+                prof_record(ctx->prof, ctx->release, start, clock_ns());
+#endif /* TIMESLICE_PROFILE */
+            }
+#else /* !TIMESLICE_PROFILE && !TIMESLICE_HIST */
+            sched->ctx->exec(sched->ctx->argv);
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+            if (BIT(sched->ctx, STIMESLICE_ONCE))
             {
-                stimeslice_drop(local->ctx);
+                stimeslice_drop_r(sched, sched->ctx);
             }
+            stimeslice_current_ = last;
         }
     }
 }
 
+void stimeslice_tick(void)
+{
+    stimeslice_tick_r(local);
+}
+
+void stimeslice_exec(void)
+{
+    stimeslice_exec_r(local);
+}
+
 void stimeslice_cron(stimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice)
 {
     slist_init(ctx->node);
+    slist_init(ctx->ready);
     ctx->slice = slice;
     ctx->timer = slice;
     ctx->exec = exec;
     ctx->argv = argv;
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    ctx->release = 0;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    prof_reset(ctx->prof);
+#endif /* TIMESLICE_PROFILE */
     ctx->stat = STIMESLICE_CRON;
 }
 
 void stimeslice_once(stimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay)
 {
     slist_init(ctx->node);
+    slist_init(ctx->ready);
     ctx->slice = delay;
     ctx->timer = delay;
     ctx->exec = exec;
     ctx->argv = argv;
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    ctx->release = 0;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    prof_reset(ctx->prof);
+#endif /* TIMESLICE_PROFILE */
     ctx->stat = STIMESLICE_ONCE;
 }
 
 void stimeslice_set_exec(stimeslice_s *ctx, void (*exec)(void *))
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     ctx->exec = exec;
 }
 void stimeslice_set_argv(stimeslice_s *ctx, void *argv)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     ctx->argv = argv;
 }
 void stimeslice_set_timer(stimeslice_s *ctx, size_t timer)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     ctx->timer = timer;
 }
 void stimeslice_set_slice(stimeslice_s *ctx, size_t slice)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     ctx->slice = slice;
 }
 
-void stimeslice_join(stimeslice_s *ctx)
+void stimeslice_join_r(stimeslice_sched_s *sched, stimeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     if (NOT(ctx, STIMESLICE_JOIN))
     {
         SET(ctx, STIMESLICE_JOIN);
         if (slist_null(ctx->node))
         {
-            slist_add(local->running, ctx->node);
+            slist_add(sched->running, ctx->node);
         }
-        ++local->counter;
+        ++sched->counter;
     }
 }
+void stimeslice_join(stimeslice_s *ctx)
+{
+    stimeslice_join_r(local, ctx);
+}
 
-void stimeslice_drop(stimeslice_s *ctx)
+void stimeslice_drop_r(stimeslice_sched_s *sched, stimeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     if (HAS(ctx, STIMESLICE_JOIN))
     {
         CLR(ctx, STIMESLICE_CTRL);
-        --local->counter;
+        --sched->counter;
     }
 }
+void stimeslice_drop(stimeslice_s *ctx)
+{
+    stimeslice_drop_r(local, ctx);
+}
 
 int stimeslice_exist(const stimeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     return HAS(ctx, STIMESLICE_JOIN);
 }
 
 size_t stimeslice_timer(const stimeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     return ctx->timer;
 }
 size_t stimeslice_slice(const stimeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : stimeslice_current_;
     return ctx->slice;
 }
+size_t stimeslice_count_r(const stimeslice_sched_s *sched)
+{
+    return sched->counter;
+}
 size_t stimeslice_count(void)
 {
-    return local->counter;
+    return stimeslice_count_r(local);
+}
+
+#if defined(TIMESLICE_HIST)
+void stimeslice_hist_attach_r(stimeslice_sched_s *sched, timeslice_hist_s *hist)
+{
+    sched->hist = hist;
+}
+void stimeslice_hist_attach(timeslice_hist_s *hist)
+{
+    stimeslice_hist_attach_r(local, hist);
+}
+#endif /* TIMESLICE_HIST */
+
+#if defined(TIMESLICE_PROFILE)
+void stimeslice_prof(const stimeslice_s *ctx, timeslice_prof_s *prof)
+{
+    ctx = ctx ? ctx : stimeslice_current_;
+    *prof = *ctx->prof;
+}
+
+void stimeslice_prof_reset(stimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : stimeslice_current_;
+    prof_reset(ctx->prof);
+}
+
+void stimeslice_prof_each_r(const stimeslice_sched_s *sched,
+                            void (*each)(const stimeslice_s *, const timeslice_prof_s *, void *), void *argv)
+{
+    const stimeslice_s *ctx;
+    const slist_u *node;
+    slist_foreach(node, sched->running)
+    {
+        ctx = slist_entry(node, const stimeslice_s, node);
+        /* the dropped tasks are unlinked lazily by the tick */
+        if (HAS(ctx, STIMESLICE_JOIN))
+        {
+            each(ctx, ctx->prof, argv);
+        }
+    }
+}
+void stimeslice_prof_each(void (*each)(const stimeslice_s *, const timeslice_prof_s *, void *), void *argv)
+{
+    stimeslice_prof_each_r(local, each, argv);
 }
+#endif /* TIMESLICE_PROFILE */
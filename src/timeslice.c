@@ -5,10 +5,32 @@
 */
 
 #include "timeslice.h"
+#include "atomic.h"
+#include "clock.h"
+#include "futex.h"
+#if defined(TIMESLICE_IO)
+#include "iowait.h"
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_PROFILE)
+#include "prof.h"
+#endif /* TIMESLICE_PROFILE */
 
-#define BIT(ctx, bit) ((ctx)->stat & (bit))
-#define SET(ctx, bit) ((ctx)->stat |= (bit))
-#define CLR(ctx, bit) ((ctx)->stat &= ~(bit))
+#define BIT(ctx, bit) (ATOMIC_LOAD((ctx)->stat) & (bit))
+#define SET(ctx, bit) ATOMIC_OR((ctx)->stat, (bit))
+#define CLR(ctx, bit) ATOMIC_AND((ctx)->stat, ~(bit))
+
+#if defined(TIMESLICE_TRACE)
+#define TRACE(sched, event, ctx, arg)                                                   \
+    do                                                                                  \
+    {                                                                                   \
+        if ((sched)->trace)                                                             \
+        {                                                                               \
+            timeslice_trace_put((sched)->trace, TIMESLICE_TRACE_##event, (ctx), (arg)); \
+        }                                                                               \
+    } while (0)
+#else /* !TIMESLICE_TRACE */
+#define TRACE(sched, event, ctx, arg) ((void)0)
+#endif /* TIMESLICE_TRACE */
 
 /*!
  @brief timeslice flags
@@ -17,145 +39,1204 @@ enum
 {
     TIMESLICE_CTRL = 0x000F, //!< Register for control
     TIMESLICE_EXEC = 1 << 0, //!< Bit that the task needs to execute
+    TIMESLICE_JOIN = 1 << 1, //!< Bit which the task has been joined
+    TIMESLICE_TIME = 1 << 2, //!< Bit that the timer has been set outside the tick
     TIMESLICE_STAT = 0x00F0, //!< Register for status
-    TIMESLICE_LOCK = 1 << 4, //!< Bit that the task has been locked
+    TIMESLICE_LINK = 1 << 4, //!< Bit that the task is in the running list
+    TIMESLICE_WAIT = 1 << 5, //!< Bit that the task is queued for the exec
+    TIMESLICE_PEND = 1 << 6, //!< Bit that the task is in the pending stack
+    TIMESLICE_RUN = 1 << 7, //!< Bit that the task is executing
     TIMESLICE_TYPE = 0x0F00, //!< Register for type
     TIMESLICE_CRON = 1 << 8, //!< Bit for the cron task
     TIMESLICE_ONCE = 1 << 9, //!< Bit for the once task
+    TIMESLICE_FILE = 1 << 10, //!< Bit for the io task
+    TIMESLICE_PRIO = 0x7000, //!< Register for priority
+#if defined(TIMESLICE_OVERRUN)
+    TIMESLICE_OVER = 0x30000, //!< Register for the overrun policy
+    TIMESLICE_CAPS = 0xFF00000, //!< Register for the cap of the catch-up executions
+#endif /* TIMESLICE_OVERRUN */
 };
+#define TIMESLICE_PRIO_SHIFT 12
+#if defined(TIMESLICE_OVERRUN)
+#define TIMESLICE_OVER_SHIFT 16
+#define TIMESLICE_CAPS_SHIFT 20
+#endif /* TIMESLICE_OVERRUN */
+#if defined(TIMESLICE_IO)
+/* the count of ready file descriptors that one wait takes */
+#define TIMESLICE_POLL 16
+#endif /* TIMESLICE_IO */
 
-static struct
-{
-    list_s running[1];
-    timeslice_s *ctx;
-    size_t counter;
-} local[1] = {{
+static timeslice_sched_s local[1] = {{
     {{local->running, local->running}},
+    {{0, 0}},
+#if defined(TIMESLICE_EDF)
+    0,
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_ATOMIC)
+    0,
+#endif /* TIMESLICE_ATOMIC */
+    0,
+#if defined(TIMESLICE_TRACE)
+    0,
+#endif /* TIMESLICE_TRACE */
+#if defined(TIMESLICE_HIST)
+    0,
+#endif /* TIMESLICE_HIST */
+    0,
+    0,
+    0,
+#if defined(TIMESLICE_EDF)
+    TIMESLICE_POLICY_PRIO,
+#endif /* TIMESLICE_EDF */
+    0,
     0,
+#if defined(TIMESLICE_IO)
+    -1,
+    -1,
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_ATOMIC)
     0,
+    0,
+#endif /* TIMESLICE_ATOMIC */
 }};
 
-static inline void timeslice_join_(timeslice_s *ctx)
+/* the task whose function is executing on this thread, which a null task refers to */
+static ATOMIC_LOCAL timeslice_s *timeslice_current_;
+
+void timeslice_sched_init(timeslice_sched_s *sched)
 {
-    list_add(local->running, ctx->node);
-    ++local->counter;
+    list_init(sched->running);
+#if defined(TIMESLICE_ATOMIC)
+    sched->pending = 0;
+#endif /* TIMESLICE_ATOMIC */
+    sched->ctx = 0;
+#if defined(TIMESLICE_TRACE)
+    sched->trace = 0;
+#endif /* TIMESLICE_TRACE */
+#if defined(TIMESLICE_HIST)
+    sched->hist = 0;
+#endif /* TIMESLICE_HIST */
+    sched->counter = 0;
+    sched->now = 0;
+#if defined(TIMESLICE_EDF)
+    sched->deadline = 0;
+    sched->policy = TIMESLICE_POLICY_PRIO;
+#endif /* TIMESLICE_EDF */
+    for (unsigned int i = 0; i != TIMESLICE_LEVEL; ++i)
+    {
+        sched->level[i][0] = sched->level[i][1] = 0;
+    }
+    sched->bitmap = 0;
+    sched->wake = 0;
+    sched->idle = 0;
+#if defined(TIMESLICE_IO)
+    sched->epoll = -1;
+    sched->kick = -1;
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_ATOMIC)
+    sched->ticker = 0;
+    sched->runner = 0;
+#endif /* TIMESLICE_ATOMIC */
 }
 
-static inline void timeslice_drop_(timeslice_s *ctx)
+#if defined(TIMESLICE_EDF)
+void timeslice_set_policy_r(timeslice_sched_s *sched, int policy)
 {
-    list_del(ctx->node);
-    --local->counter;
+    sched->policy = policy;
 }
+#endif /* TIMESLICE_EDF */
 
-void timeslice_tick(void)
+size_t timeslice_now_r(const timeslice_sched_s *sched)
 {
-    timeslice_s *ctx;
+    return ATOMIC_LOAD(sched->now);
+}
+
+timeslice_s *timeslice_self_r(const timeslice_sched_s *sched)
+{
+    return sched->ctx;
+}
+
+#if defined(TIMESLICE_ATOMIC)
+/* the address of a thread-local variable tells the threads apart */
+static ATOMIC_LOCAL int timeslice_thread_;
+/* the tick and the exec mark the thread that they run on, and a drop on that thread may change their side */
+#define TIMESLICE_MARK(side) ATOMIC_STORE(side, (const void *)&timeslice_thread_)
+/* a side that has not run yet belongs to any thread */
+#define TIMESLICE_OWNS(side) \
+    (ATOMIC_LOAD(side) == (const void *)&timeslice_thread_ || ATOMIC_LOAD(side) == (const void *)0)
+#else /* !TIMESLICE_ATOMIC */
+#define TIMESLICE_MARK(side) ((void)0)
+#define TIMESLICE_OWNS(side) 1
+#endif /* TIMESLICE_ATOMIC */
+
+/*
+ every priority level has a ready queue, whose head is queue[0] and whose tail is queue[1]; it is appended
+ to by the tick and by the notices, each with one exchange of the tail, and only the exec takes from its head,
+ so neither side waits for the other
+*/
+static void timeslice_push_(timeslice_s **queue, timeslice_s *head, timeslice_s *tail)
+{
+    timeslice_s *prev;
+    tail->next = 0;
+#if defined(TIMESLICE_ATOMIC)
+    prev = ATOMIC_XCHG(queue[1], tail);
+#else /* !TIMESLICE_ATOMIC */
+    prev = queue[1];
+    queue[1] = tail;
+#endif /* TIMESLICE_ATOMIC */
+    if (prev)
+    {
+        ATOMIC_STORE(prev->next, head);
+    }
+    else
+    {
+        ATOMIC_STORE(queue[0], head);
+    }
+}
+
+/* the last task of a ready queue stays while a push is linking behind it */
+static timeslice_s *timeslice_pop_(timeslice_s **queue)
+{
+    timeslice_s *ctx = ATOMIC_LOAD(queue[0]), *next, *last;
+    if (!ctx)
+    {
+        return 0;
+    }
+    next = ATOMIC_LOAD(ctx->next);
+    if (next)
+    {
+        ATOMIC_STORE(queue[0], next);
+        return ctx;
+    }
+    last = ctx;
+    if (!ATOMIC_CAS(queue[1], last, next))
+    {
+        return 0;
+    }
+    /* a push that finds no tail sets the head itself */
+    last = ctx;
+    ATOMIC_CAS(queue[0], last, next);
+    return ctx;
+}
+
+/* take a task out of a ready queue, unless a push is linking behind it */
+static int timeslice_cut_(timeslice_s **queue, timeslice_s *ctx)
+{
+    timeslice_s *prev = 0, *node, *next, *last;
+    for (node = ATOMIC_LOAD(queue[0]); node != ctx; prev = node, node = ATOMIC_LOAD(node->next))
+    {
+        if (!node)
+        {
+            return 0;
+        }
+    }
+    next = ATOMIC_LOAD(ctx->next);
+    if (next)
+    {
+        if (prev)
+        {
+            ATOMIC_STORE(prev->next, next);
+        }
+        else
+        {
+            ATOMIC_STORE(queue[0], next);
+        }
+        return 1;
+    }
+    /* the last task hands the tail back to the one before it */
+    if (prev)
+    {
+        ATOMIC_STORE(prev->next, next);
+    }
+    last = ctx;
+    if (!ATOMIC_CAS(queue[1], last, prev))
+    {
+        if (prev)
+        {
+            ATOMIC_STORE(prev->next, ctx);
+        }
+        return 0;
+    }
+    if (!prev)
+    {
+        last = ctx;
+        ATOMIC_CAS(queue[0], last, next);
+    }
+    return 1;
+}
+
+/* the bit of a level is set after its queue is appended to, and only the exec clears it */
+static inline void timeslice_ready_(timeslice_sched_s *sched, unsigned int prio, timeslice_s *head, timeslice_s *tail)
+{
+    timeslice_push_(sched->level[prio], head, tail);
+    ATOMIC_OR(sched->bitmap, 1U << prio);
+}
+
+static inline int timeslice_none_(timeslice_sched_s *sched)
+{
+#if defined(TIMESLICE_EDF)
+    if (sched->deadline)
+    {
+        return 0;
+    }
+#endif /* TIMESLICE_EDF */
+    return !ATOMIC_LOAD(sched->bitmap);
+}
+
+/* the exec sleeps on the epoll instance once it is open, and on the futex before */
+static void timeslice_kick_(timeslice_sched_s *sched)
+{
+#if defined(TIMESLICE_IO)
+    if (ATOMIC_LOAD(sched->epoll) >= 0)
+    {
+        iowait_kick(sched->kick);
+    }
+#endif /* TIMESLICE_IO */
+    futex_wake(&sched->wake);
+}
+
+/* the sleeping exec is only woken by a system call if it has announced itself */
+static inline void timeslice_wake_(timeslice_sched_s *sched)
+{
+    ATOMIC_ADD(sched->wake, 1);
+    ATOMIC_FENCE();
+    if (ATOMIC_LOAD(sched->idle))
+    {
+        timeslice_kick_(sched);
+    }
+}
+
+#if defined(TIMESLICE_IO)
+/* the first join of an io task opens the epoll instance, and the joins that race with it wait */
+static int timeslice_epoll_(timeslice_sched_s *sched)
+{
+    int epoll = ATOMIC_LOAD(sched->epoll);
+#if defined(TIMESLICE_ATOMIC)
+    while (epoll < 0)
+    {
+        if (epoll == -1)
+        {
+            if (ATOMIC_CAS(sched->epoll, epoll, -2))
+            {
+                epoll = iowait_open(&sched->kick);
+                ATOMIC_STORE(sched->epoll, epoll);
+                return epoll;
+            }
+        }
+        else
+        {
+            epoll = ATOMIC_LOAD(sched->epoll);
+        }
+    }
+#else /* !TIMESLICE_ATOMIC */
+    if (epoll < 0)
+    {
+        epoll = iowait_open(&sched->kick);
+        sched->epoll = epoll;
+    }
+#endif /* TIMESLICE_ATOMIC */
+    return epoll;
+}
+#endif /* TIMESLICE_IO */
+
+/* link or unlink a task by its join bit */
+static void timeslice_link_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    int stat = ATOMIC_LOAD(ctx->stat);
+    if (stat & TIMESLICE_JOIN)
+    {
+        if (!(stat & TIMESLICE_LINK))
+        {
+            SET(ctx, TIMESLICE_LINK);
+            list_add(sched->running, ctx->node);
+        }
+    }
+    else if (stat & TIMESLICE_LINK)
+    {
+        /* the task is not touched once the scheduler lets go of it */
+        list_del(ctx->node);
+        CLR(ctx, TIMESLICE_LINK);
+    }
+}
+
+/* post a task whose join bit changed, the tick links or unlinks it later */
+static void timeslice_post_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+#if defined(TIMESLICE_ATOMIC)
+    if (SET(ctx, TIMESLICE_PEND) & TIMESLICE_PEND)
+    {
+        return;
+    }
+    ctx->link = ATOMIC_LOAD(sched->pending);
+    while (!ATOMIC_CAS(sched->pending, ctx->link, ctx))
+    {
+    }
+#else /* !TIMESLICE_ATOMIC */
+    /* in a single context the running list is changed at once */
+    timeslice_link_(sched, ctx);
+#endif /* TIMESLICE_ATOMIC */
+}
+
+/* apply the posted joins and drops in the order of posting */
+static void timeslice_sync_(timeslice_sched_s *sched)
+{
+#if defined(TIMESLICE_ATOMIC)
+    int stat;
+    timeslice_s *ctx, *link, *list = 0;
+    for (ctx = ATOMIC_XCHG(sched->pending, (timeslice_s *)0); ctx; ctx = link)
+    {
+        link = ctx->link;
+        ctx->link = list;
+        list = ctx;
+    }
+    for (ctx = list; ctx; ctx = link)
+    {
+        link = ctx->link;
+        /* the pending bit goes last, since a task that is not held may be freed at once */
+        timeslice_link_(sched, ctx);
+        stat = CLR(ctx, TIMESLICE_PEND);
+        /* a join or drop that was posted meanwhile found the bit set, and a joined or linked task is held */
+        if (!(stat & TIMESLICE_JOIN) != !(stat & TIMESLICE_LINK))
+        {
+            timeslice_link_(sched, ctx);
+        }
+    }
+#else /* !TIMESLICE_ATOMIC */
+    (void)sched;
+#endif /* TIMESLICE_ATOMIC */
+}
+
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+/* a release that finds the task still due and the periods skipped within one advance are missed */
+static void timeslice_release_(timeslice_s *ctx, size_t missed)
+{
+    if (BIT(ctx, TIMESLICE_EXEC))
+    {
+        ++missed;
+    }
+    else
+    {
+        ATOMIC_STORE(ctx->release, clock_ns());
+    }
+#if defined(TIMESLICE_PROFILE)
+    if (missed)
+    {
+        ATOMIC_ADD(ctx->prof->missed, missed);
+    }
+#endif /* TIMESLICE_PROFILE */
+    (void)missed;
+}
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+
+void timeslice_advance_r(timeslice_sched_s *sched, size_t elapsed)
+{
+    int stat;
     list_s *node, *next;
-    list_forsafe(node, next, local->running)
+    timeslice_s *ctx, *batch[TIMESLICE_LEVEL][2];
+    unsigned int prio, ready = 0;
+    size_t timer, slice, over;
+    size_t now = sched->now + elapsed;
+    ATOMIC_STORE(sched->now, now);
+    TRACE(sched, TICK, 0, elapsed);
+    TIMESLICE_MARK(sched->ticker);
+#if defined(TIMESLICE_ATOMIC)
+    if (ATOMIC_LOAD(sched->pending))
+    {
+        timeslice_sync_(sched);
+    }
+#endif /* TIMESLICE_ATOMIC */
+    list_forsafe(node, next, sched->running)
     {
         ctx = list_entry(node, timeslice_s, node);
-        if (ctx->timer && --ctx->timer == 0)
+        stat = ATOMIC_LOAD(ctx->stat);
+        timer = ATOMIC_LOAD(ctx->timer);
+#if defined(TIMESLICE_ATOMIC)
+        /* the timer is only written by the tick, which takes over a timer that was set elsewhere */
+        if (stat & TIMESLICE_TIME)
+        {
+            CLR(ctx, TIMESLICE_TIME);
+            timer = ATOMIC_LOAD(ctx->reset);
+        }
+#endif /* TIMESLICE_ATOMIC */
+        if (timer && elapsed < timer)
+        {
+            ATOMIC_STORE(ctx->timer, timer - elapsed);
+        }
+        else if (timer)
+        {
+            /* the periods that expired within the elapsed ticks keep the phase */
+            size_t missed = 0;
+            slice = ATOMIC_LOAD(ctx->slice);
+            over = elapsed - timer;
+            if (slice && over >= slice)
+            {
+                missed = over / slice;
+                over %= slice;
+            }
+            ATOMIC_STORE(ctx->timer, slice ? slice - over : 0);
+            /* the release of the last period that expired */
+            ATOMIC_STORE(ctx->stamp, now - over);
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+            timeslice_release_(ctx, missed);
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+            stat = SET(ctx, TIMESLICE_EXEC);
+            /* the argument tells that the task was still due */
+            TRACE(sched, DUE, ctx, (size_t)(stat & TIMESLICE_EXEC));
+#if defined(TIMESLICE_OVERRUN)
+            missed += (size_t)(stat & TIMESLICE_EXEC);
+            if (missed)
+            {
+                ATOMIC_ADD(ctx->missed, missed);
+            }
+#endif /* TIMESLICE_OVERRUN */
+            (void)missed;
+            stat |= TIMESLICE_EXEC;
+        }
+        /* the due tasks of one advance are appended to the ready queues at once, in the order of the list */
+        if ((stat & (TIMESLICE_EXEC | TIMESLICE_WAIT)) == TIMESLICE_EXEC &&
+            !(SET(ctx, TIMESLICE_WAIT) & TIMESLICE_WAIT))
+        {
+            prio = (unsigned int)(stat & TIMESLICE_PRIO) >> TIMESLICE_PRIO_SHIFT;
+            if (ready & (1U << prio))
+            {
+                batch[prio][1]->next = ctx;
+            }
+            else
+            {
+                batch[prio][0] = ctx;
+                ready |= 1U << prio;
+            }
+            batch[prio][1] = ctx;
+        }
+    }
+    if (ready)
+    {
+        for (prio = 0; prio != TIMESLICE_LEVEL; ++prio)
         {
-            SET(ctx, TIMESLICE_EXEC);
-            ctx->timer = ctx->slice;
+            if (ready & (1U << prio))
+            {
+                timeslice_ready_(sched, prio, batch[prio][0], batch[prio][1]);
+            }
         }
+        timeslice_wake_(sched);
     }
 }
 
-void timeslice_exec(void)
+void timeslice_tick_r(timeslice_sched_s *sched)
+{
+    timeslice_advance_r(sched, 1);
+}
+
+size_t timeslice_next_expiry_r(timeslice_sched_s *sched)
 {
+    int stat;
+    timeslice_s *ctx;
     list_s *node, *next;
-    list_forsafe(node, next, local->running)
+    size_t timer, expiry = 0;
+    TIMESLICE_MARK(sched->ticker);
+#if defined(TIMESLICE_ATOMIC)
+    if (ATOMIC_LOAD(sched->pending))
+    {
+        timeslice_sync_(sched);
+    }
+#endif /* TIMESLICE_ATOMIC */
+    list_forsafe(node, next, sched->running)
     {
-        local->ctx = list_entry(node, timeslice_s, node);
-        if (BIT(local->ctx, TIMESLICE_EXEC))
+        ctx = list_entry(node, timeslice_s, node);
+        stat = ATOMIC_LOAD(ctx->stat);
+        if ((stat & (TIMESLICE_EXEC | TIMESLICE_WAIT)) == TIMESLICE_EXEC)
+        {
+            expiry = 1;
+            break;
+        }
+        timer = timeslice_timer(ctx);
+        if (timer && (expiry == 0 || timer < expiry))
         {
-            CLR(local->ctx, TIMESLICE_EXEC);
-            local->ctx->exec(local->ctx->argv);
-            if (BIT(local->ctx, TIMESLICE_ONCE))
+            expiry = timer;
+        }
+    }
+    return expiry;
+}
+
+#if defined(TIMESLICE_EDF)
+/* the earlier deadline goes first, which survives the wrap around of the tick count */
+static int timeslice_cmp_(const pheap_s *lhs, const pheap_s *rhs)
+{
+    const timeslice_s *l = pheap_entry(lhs, const timeslice_s, heap);
+    const timeslice_s *r = pheap_entry(rhs, const timeslice_s, heap);
+    size_t diff = l->deadline - r->deadline;
+    if (diff)
+    {
+        return diff > ((size_t)~(size_t)0 >> 1) ? -1 : 1;
+    }
+    return BIT(r, TIMESLICE_PRIO) - BIT(l, TIMESLICE_PRIO);
+}
+
+/* move the tasks of the ready queues into the deadline heap */
+static void timeslice_rank_(timeslice_sched_s *sched)
+{
+    timeslice_s *ctx;
+    unsigned int prio;
+    for (prio = 0; prio != TIMESLICE_LEVEL; ++prio)
+    {
+        while ((ctx = timeslice_pop_(sched->level[prio])) != 0)
+        {
+            /* the deadline is fixed while queued, since the tick may release the task again */
+            ctx->deadline = ATOMIC_LOAD(ctx->stamp);
+            if (BIT(ctx, TIMESLICE_CRON))
             {
-                timeslice_drop_(local->ctx);
+                ctx->deadline += ATOMIC_LOAD(ctx->slice);
             }
+            pheap_init(ctx->heap);
+            sched->deadline = pheap_add(sched->deadline, ctx->heap, timeslice_cmp_);
         }
     }
 }
+#endif /* TIMESLICE_EDF */
+
+/* pop the earliest deadline, or the first task of the highest ready queue that is not empty */
+static timeslice_s *timeslice_pick_(timeslice_sched_s *sched)
+{
+    timeslice_s *ctx, **level;
+    unsigned int prio, bitmap;
+#if defined(TIMESLICE_EDF)
+    if (sched->policy == TIMESLICE_POLICY_EDF)
+    {
+        timeslice_rank_(sched);
+    }
+    if (sched->deadline)
+    {
+        ctx = pheap_entry(sched->deadline, timeslice_s, heap);
+        sched->deadline = pheap_del(sched->deadline, ctx->heap, timeslice_cmp_);
+        return ctx;
+    }
+#endif /* TIMESLICE_EDF */
+    while ((bitmap = ATOMIC_LOAD(sched->bitmap)) != 0)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        prio = (unsigned int)(sizeof(bitmap) * 8 - 1) - (unsigned int)__builtin_clz(bitmap);
+#else /* !__GNUC__ */
+        for (prio = TIMESLICE_LEVEL - 1; !(bitmap >> prio); --prio)
+        {
+        }
+#endif /* __GNUC__ */
+        level = sched->level[prio];
+        if ((ctx = timeslice_pop_(level)) != 0)
+        {
+            return ctx;
+        }
+        if (ATOMIC_LOAD(level[0]))
+        {
+            /* a push is linking behind the last task, and the exec comes back for it */
+            return 0;
+        }
+        /* the bit is set again for a push that finished after the queue was found empty */
+        ATOMIC_AND(sched->bitmap, ~(1U << prio));
+        if (ATOMIC_LOAD(level[0]))
+        {
+            ATOMIC_OR(sched->bitmap, 1U << prio);
+        }
+    }
+    return 0;
+}
+
+/* take a dropped task out of the deadline heap or its ready queue, and leave the other tasks where they are */
+static void timeslice_unqueue_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    unsigned int prio;
+    if ((ATOMIC_LOAD(ctx->stat) & (TIMESLICE_JOIN | TIMESLICE_WAIT)) != TIMESLICE_WAIT)
+    {
+        return;
+    }
+#if defined(TIMESLICE_EDF)
+    if (sched->deadline && (ctx->heap == sched->deadline || ctx->heap->prev))
+    {
+        sched->deadline = pheap_del(sched->deadline, ctx->heap, timeslice_cmp_);
+        CLR(ctx, TIMESLICE_EXEC | TIMESLICE_WAIT);
+        return;
+    }
+#endif /* TIMESLICE_EDF */
+    for (prio = 0; prio != TIMESLICE_LEVEL; ++prio)
+    {
+        if (timeslice_cut_(sched->level[prio], ctx))
+        {
+            CLR(ctx, TIMESLICE_EXEC | TIMESLICE_WAIT);
+            return;
+        }
+    }
+}
+
+/*
+ settle a dropped task on the sides that run on the calling thread, so that it can be initialized again
+ at once, and the side of another thread lets go of it when it walks the task next time
+*/
+static void timeslice_settle_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    int stat = ATOMIC_LOAD(ctx->stat);
+    if ((stat & (TIMESLICE_LINK | TIMESLICE_PEND)) && TIMESLICE_OWNS(sched->ticker))
+    {
+        timeslice_sync_(sched);
+    }
+    if ((stat & TIMESLICE_WAIT) && TIMESLICE_OWNS(sched->runner))
+    {
+        timeslice_unqueue_(sched, ctx);
+    }
+}
+
+static inline void timeslice_call_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    TRACE(sched, START, ctx, 0);
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    {
+        uint64_t release = ATOMIC_LOAD(ctx->release);
+        uint64_t start = clock_ns();
+#if defined(TIMESLICE_HIST)
+        if (sched->hist)
+        {
+            timeslice_hist_add(sched->hist, start - release);
+        }
+#endif /* TIMESLICE_HIST */
+        ctx->exec(ctx->argv);
+#if defined(TIMESLICE_PROFILE)
+        prof_record(ctx->prof, release, start, clock_ns());
+#endif /* TIMESLICE_PROFILE */
+    }
+#else /* !TIMESLICE_PROFILE && !TIMESLICE_HIST */
+    ctx->exec(ctx->argv);
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+    TRACE(sched, END, ctx, 0);
+    (void)sched;
+}
+
+#if defined(TIMESLICE_OVERRUN)
+/* execute a due task by its overrun policy */
+static void timeslice_over_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    int stat = BIT(ctx, TIMESLICE_OVER | TIMESLICE_CAPS);
+    size_t again = 0;
+#if defined(TIMESLICE_ATOMIC)
+    ctx->overrun = ATOMIC_XCHG(ctx->missed, (size_t)0);
+#else /* !TIMESLICE_ATOMIC */
+    ctx->overrun = ctx->missed;
+    ctx->missed = 0;
+#endif /* TIMESLICE_ATOMIC */
+    if ((stat & TIMESLICE_OVER) >> TIMESLICE_OVER_SHIFT == TIMESLICE_OVERRUN_CATCHUP)
+    {
+        again = (size_t)(stat & TIMESLICE_CAPS) >> TIMESLICE_CAPS_SHIFT;
+        again = again < ctx->overrun ? again : ctx->overrun;
+    }
+    timeslice_call_(sched, ctx);
+    /* the executions that catch up stop when the task drops itself */
+    for (; again && BIT(ctx, TIMESLICE_JOIN); --again)
+    {
+        --ctx->overrun;
+        timeslice_call_(sched, ctx);
+    }
+    if ((stat & TIMESLICE_OVER) >> TIMESLICE_OVER_SHIFT == TIMESLICE_OVERRUN_SHIFT && ctx->overrun)
+    {
+        timeslice_set_timer(ctx, ATOMIC_LOAD(ctx->slice));
+    }
+}
+#endif /* TIMESLICE_OVERRUN */
+
+/* execute a due task, then drop it if it is a once task */
+static void timeslice_fire_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    timeslice_s *last = timeslice_current_;
+    timeslice_current_ = ctx;
+#if defined(TIMESLICE_OVERRUN)
+    timeslice_over_(sched, ctx);
+#else /* !TIMESLICE_OVERRUN */
+    timeslice_call_(sched, ctx);
+#endif /* TIMESLICE_OVERRUN */
+#if defined(TIMESLICE_IO)
+    ctx->revents = 0;
+#endif /* TIMESLICE_IO */
+    if (BIT(ctx, TIMESLICE_ONCE))
+    {
+        timeslice_drop_r(sched, ctx);
+    }
+    timeslice_current_ = last;
+}
+
+/* clear and set the bits of a task in one step, and return the bits that it had */
+static inline int timeslice_swap_(timeslice_s *ctx, int clr, int set)
+{
+    int stat = ATOMIC_LOAD(ctx->stat);
+    while (!ATOMIC_CAS(ctx->stat, stat, (stat & ~clr) | set))
+    {
+    }
+    return stat;
+}
+
+/* the task is held as running until the callback returns, so it is not freed under it */
+static inline void timeslice_run_(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    int stat = timeslice_swap_(ctx, TIMESLICE_EXEC | TIMESLICE_WAIT, TIMESLICE_RUN);
+    if ((stat & (TIMESLICE_EXEC | TIMESLICE_JOIN)) == (TIMESLICE_EXEC | TIMESLICE_JOIN))
+    {
+        sched->ctx = ctx;
+        timeslice_fire_(sched, sched->ctx);
+    }
+    CLR(ctx, TIMESLICE_RUN);
+}
+
+void timeslice_exec_r(timeslice_sched_s *sched)
+{
+    timeslice_s *ctx;
+    TIMESLICE_MARK(sched->runner);
+    while ((ctx = timeslice_pick_(sched)) != 0)
+    {
+        timeslice_run_(sched, ctx);
+    }
+}
+
+int timeslice_exec_budget_r(timeslice_sched_s *sched, uint64_t budget)
+{
+    timeslice_s *ctx;
+    uint64_t start = clock_ns();
+    TIMESLICE_MARK(sched->runner);
+    while ((ctx = timeslice_pick_(sched)) != 0)
+    {
+        timeslice_run_(sched, ctx);
+        /* the tasks that are left over keep their place in the run queue */
+        if (clock_ns() - start >= budget)
+        {
+            return !timeslice_none_(sched);
+        }
+    }
+    return 0;
+}
+
+void timeslice_exec_wait_r(timeslice_sched_s *sched)
+{
+#if defined(TIMESLICE_IO)
+    void *data[TIMESLICE_POLL];
+    unsigned int events[TIMESLICE_POLL];
+    int epoll = ATOMIC_LOAD(sched->epoll);
+    int count = 0;
+#endif /* TIMESLICE_IO */
+    int wake = ATOMIC_LOAD(sched->wake);
+    if (timeslice_none_(sched))
+    {
+        ATOMIC_ADD(sched->idle, 1);
+        ATOMIC_FENCE();
+        if (timeslice_none_(sched))
+        {
+#if defined(TIMESLICE_IO)
+            if (epoll >= 0)
+            {
+                count = iowait_wait(epoll, sched->kick, data, events, TIMESLICE_POLL, -1);
+            }
+            else
+            {
+                futex_wait(&sched->wake, wake);
+            }
+#else /* !TIMESLICE_IO */
+            futex_wait(&sched->wake, wake);
+#endif /* TIMESLICE_IO */
+        }
+        ATOMIC_SUB(sched->idle, 1);
+    }
+#if defined(TIMESLICE_IO)
+    else if (epoll >= 0)
+    {
+        count = iowait_wait(epoll, sched->kick, data, events, TIMESLICE_POLL, 0);
+    }
+    /* a ready file descriptor notifies its task and restarts the timeout */
+    for (int i = 0; i < count; ++i)
+    {
+        timeslice_s *ctx = (timeslice_s *)data[i];
+        ctx->revents |= events[i];
+        timeslice_set_timer(ctx, ATOMIC_LOAD(ctx->slice));
+        timeslice_notify_r(sched, ctx);
+    }
+#endif /* TIMESLICE_IO */
+    timeslice_exec_r(sched);
+}
+
+void timeslice_wake_r(timeslice_sched_s *sched)
+{
+    ATOMIC_ADD(sched->wake, 1);
+    timeslice_kick_(sched);
+}
+
+timeslice_s *timeslice_pull_r(timeslice_sched_s *sched)
+{
+    return timeslice_pick_(sched);
+}
+
+int timeslice_call_r(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    int stat = timeslice_swap_(ctx, TIMESLICE_EXEC, TIMESLICE_RUN);
+    int due;
+    if ((stat & (TIMESLICE_EXEC | TIMESLICE_JOIN)) == (TIMESLICE_EXEC | TIMESLICE_JOIN))
+    {
+        timeslice_fire_(sched, ctx);
+    }
+    /* the task that became due again while executing stays queued with the caller */
+    stat = ATOMIC_LOAD(ctx->stat);
+    do
+    {
+        due = (stat & (TIMESLICE_EXEC | TIMESLICE_JOIN)) == (TIMESLICE_EXEC | TIMESLICE_JOIN);
+    } while (!ATOMIC_CAS(ctx->stat, stat, stat & ~(TIMESLICE_RUN | (due ? 0 : TIMESLICE_WAIT))));
+    return due;
+}
+
+void timeslice_notify_r(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    /* a task that is queued already executes once for all the notices */
+    if (SET(ctx, TIMESLICE_EXEC | TIMESLICE_WAIT) & TIMESLICE_WAIT)
+    {
+        return;
+    }
+    ATOMIC_STORE(ctx->stamp, ATOMIC_LOAD(sched->now));
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    ATOMIC_STORE(ctx->release, clock_ns());
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+    timeslice_ready_(sched, (unsigned int)BIT(ctx, TIMESLICE_PRIO) >> TIMESLICE_PRIO_SHIFT, ctx, ctx);
+    timeslice_wake_(sched);
+}
+void timeslice_notify(timeslice_s *ctx)
+{
+    timeslice_notify_r(local, ctx);
+}
+
+void timeslice_tick(void)
+{
+    timeslice_tick_r(local);
+}
+
+void timeslice_advance(size_t elapsed)
+{
+    timeslice_advance_r(local, elapsed);
+}
+
+size_t timeslice_next_expiry(void)
+{
+    return timeslice_next_expiry_r(local);
+}
+
+void timeslice_exec(void)
+{
+    timeslice_exec_r(local);
+}
+
+int timeslice_exec_budget(uint64_t budget)
+{
+    return timeslice_exec_budget_r(local, budget);
+}
+
+void timeslice_exec_wait(void)
+{
+    timeslice_exec_wait_r(local);
+}
+
+#if defined(TIMESLICE_EDF)
+void timeslice_set_policy(int policy)
+{
+    timeslice_set_policy_r(local, policy);
+}
+#endif /* TIMESLICE_EDF */
+
+size_t timeslice_now(void)
+{
+    return timeslice_now_r(local);
+}
 
 void timeslice_cron(timeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice)
 {
     list_init(ctx->node);
+#if defined(TIMESLICE_EDF)
+    pheap_init(ctx->heap);
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_ATOMIC)
+    ctx->link = 0;
+#endif /* TIMESLICE_ATOMIC */
+    ctx->next = 0;
     ctx->slice = slice;
     ctx->timer = slice;
+#if defined(TIMESLICE_ATOMIC)
+    ctx->reset = 0;
+#endif /* TIMESLICE_ATOMIC */
+    ctx->stamp = 0;
+#if defined(TIMESLICE_EDF)
+    ctx->deadline = 0;
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_OVERRUN)
+    ctx->missed = 0;
+    ctx->overrun = 0;
+#endif /* TIMESLICE_OVERRUN */
     ctx->exec = exec;
     ctx->argv = argv;
+#if defined(TIMESLICE_IO)
+    ctx->fd = -1;
+    ctx->events = 0;
+    ctx->revents = 0;
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    ctx->release = 0;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    prof_reset(ctx->prof);
+#endif /* TIMESLICE_PROFILE */
     ctx->stat = TIMESLICE_CRON;
 }
 
 void timeslice_once(timeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay)
 {
     list_init(ctx->node);
+#if defined(TIMESLICE_EDF)
+    pheap_init(ctx->heap);
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_ATOMIC)
+    ctx->link = 0;
+#endif /* TIMESLICE_ATOMIC */
+    ctx->next = 0;
     ctx->slice = delay;
     ctx->timer = delay;
+#if defined(TIMESLICE_ATOMIC)
+    ctx->reset = 0;
+#endif /* TIMESLICE_ATOMIC */
+    ctx->stamp = 0;
+#if defined(TIMESLICE_EDF)
+    ctx->deadline = 0;
+#endif /* TIMESLICE_EDF */
+#if defined(TIMESLICE_OVERRUN)
+    ctx->missed = 0;
+    ctx->overrun = 0;
+#endif /* TIMESLICE_OVERRUN */
     ctx->exec = exec;
     ctx->argv = argv;
+#if defined(TIMESLICE_IO)
+    ctx->fd = -1;
+    ctx->events = 0;
+    ctx->revents = 0;
+#endif /* TIMESLICE_IO */
+#if defined(TIMESLICE_PROFILE) || defined(TIMESLICE_HIST)
+    ctx->release = 0;
+#endif /* TIMESLICE_PROFILE || TIMESLICE_HIST */
+#if defined(TIMESLICE_PROFILE)
+    prof_reset(ctx->prof);
+#endif /* TIMESLICE_PROFILE */
     ctx->stat = TIMESLICE_ONCE;
 }
 
+#if defined(TIMESLICE_IO)
+void timeslice_io(timeslice_s *ctx, void (*exec)(void *), void *argv, int fd, unsigned int events, size_t timeout)
+{
+    timeslice_cron(ctx, exec, argv, timeout);
+    ctx->fd = fd;
+    ctx->events = events;
+    ctx->stat = TIMESLICE_CRON | TIMESLICE_FILE;
+}
+#endif /* TIMESLICE_IO */
+
 void timeslice_set_exec(timeslice_s *ctx, void (*exec)(void *))
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : timeslice_current_;
     ctx->exec = exec;
 }
 void timeslice_set_argv(timeslice_s *ctx, void *argv)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : timeslice_current_;
     ctx->argv = argv;
 }
 void timeslice_set_timer(timeslice_s *ctx, size_t timer)
 {
-    ctx = ctx ? ctx : local->ctx;
+    ctx = ctx ? ctx : timeslice_current_;
+#if defined(TIMESLICE_ATOMIC)
+    ATOMIC_STORE(ctx->reset, timer);
+    SET(ctx, TIMESLICE_TIME);
+#else /* !TIMESLICE_ATOMIC */
     ctx->timer = timer;
+#endif /* TIMESLICE_ATOMIC */
 }
 void timeslice_set_slice(timeslice_s *ctx, size_t slice)
 {
-    ctx = ctx ? ctx : local->ctx;
-    ctx->slice = slice;
+    ctx = ctx ? ctx : timeslice_current_;
+    ATOMIC_STORE(ctx->slice, slice);
 }
 
-void timeslice_join(timeslice_s *ctx)
+void timeslice_set_prio(timeslice_s *ctx, unsigned int prio)
 {
-    ctx = ctx ? ctx : local->ctx;
-    if (list_null(ctx->node))
+    ctx = ctx ? ctx : timeslice_current_;
+    prio = prio < TIMESLICE_LEVEL ? prio : TIMESLICE_LEVEL - 1;
+    CLR(ctx, TIMESLICE_PRIO);
+    SET(ctx, (int)(prio << TIMESLICE_PRIO_SHIFT));
+}
+
+#if defined(TIMESLICE_OVERRUN)
+void timeslice_set_overrun(timeslice_s *ctx, int policy, unsigned int cap)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    cap = cap < TIMESLICE_OVERRUN_CAP ? cap : TIMESLICE_OVERRUN_CAP;
+    CLR(ctx, TIMESLICE_OVER | TIMESLICE_CAPS);
+    SET(ctx, (int)((unsigned int)policy << TIMESLICE_OVER_SHIFT | cap << TIMESLICE_CAPS_SHIFT) & (TIMESLICE_OVER | TIMESLICE_CAPS));
+}
+#endif /* TIMESLICE_OVERRUN */
+
+void timeslice_join_r(timeslice_sched_s *sched, timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    if (!(SET(ctx, TIMESLICE_JOIN) & TIMESLICE_JOIN))
     {
-        timeslice_join_(ctx);
+        ATOMIC_ADD(sched->counter, 1);
+        TRACE(sched, JOIN, ctx, 0);
+        timeslice_post_(sched, ctx);
+#if defined(TIMESLICE_IO)
+        /* an io task whose file descriptor cannot be watched is only released by its timeout */
+        if (BIT(ctx, TIMESLICE_FILE) && timeslice_epoll_(sched) >= 0)
+        {
+            iowait_add(sched->epoll, ctx->fd, ctx->events, ctx);
+        }
+#endif /* TIMESLICE_IO */
     }
 }
+void timeslice_join(timeslice_s *ctx)
+{
+    timeslice_join_r(local, ctx);
+}
 
-void timeslice_drop(timeslice_s *ctx)
+void timeslice_drop_r(timeslice_sched_s *sched, timeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
-    if (list_used(ctx->node))
+    ctx = ctx ? ctx : timeslice_current_;
+    if (CLR(ctx, TIMESLICE_JOIN) & TIMESLICE_JOIN)
+    {
+        ATOMIC_SUB(sched->counter, 1);
+        TRACE(sched, DROP, ctx, 0);
+        timeslice_post_(sched, ctx);
+#if defined(TIMESLICE_IO)
+        if (BIT(ctx, TIMESLICE_FILE) && ATOMIC_LOAD(sched->epoll) >= 0)
+        {
+            iowait_del(sched->epoll, ctx->fd);
+        }
+#endif /* TIMESLICE_IO */
+    }
+    if (!BIT(ctx, TIMESLICE_JOIN) && BIT(ctx, TIMESLICE_STAT))
     {
-        timeslice_drop_(ctx);
+        timeslice_settle_(sched, ctx);
     }
 }
+void timeslice_drop(timeslice_s *ctx)
+{
+    timeslice_drop_r(local, ctx);
+}
 
 int timeslice_exist(const timeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
-    return list_used(ctx->node);
+    ctx = ctx ? ctx : timeslice_current_;
+    return BIT(ctx, TIMESLICE_JOIN) != 0;
+}
+
+int timeslice_held(const timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    return BIT(ctx, TIMESLICE_STAT) != 0;
 }
 
 size_t timeslice_timer(const timeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
-    return ctx->timer;
+    ctx = ctx ? ctx : timeslice_current_;
+#if defined(TIMESLICE_ATOMIC)
+    if (BIT(ctx, TIMESLICE_TIME))
+    {
+        return ATOMIC_LOAD(ctx->reset);
+    }
+#endif /* TIMESLICE_ATOMIC */
+    return ATOMIC_LOAD(ctx->timer);
 }
 size_t timeslice_slice(const timeslice_s *ctx)
 {
-    ctx = ctx ? ctx : local->ctx;
-    return ctx->slice;
+    ctx = ctx ? ctx : timeslice_current_;
+    return ATOMIC_LOAD(ctx->slice);
+}
+unsigned int timeslice_prio(const timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    return (unsigned int)(BIT(ctx, TIMESLICE_PRIO) >> TIMESLICE_PRIO_SHIFT);
+}
+#if defined(TIMESLICE_OVERRUN)
+int timeslice_overrun(const timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    return BIT(ctx, TIMESLICE_OVER) >> TIMESLICE_OVER_SHIFT;
+}
+size_t timeslice_missed(const timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    return ctx->overrun;
+}
+#endif /* TIMESLICE_OVERRUN */
+#if defined(TIMESLICE_IO)
+unsigned int timeslice_revents(const timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    return ctx->revents;
+}
+#endif /* TIMESLICE_IO */
+
+size_t timeslice_count_r(const timeslice_sched_s *sched)
+{
+    return ATOMIC_LOAD(sched->counter);
 }
 size_t timeslice_count(void)
 {
-    return local->counter;
+    return timeslice_count_r(local);
+}
+
+#if defined(TIMESLICE_TRACE)
+void timeslice_trace_attach_r(timeslice_sched_s *sched, timeslice_trace_s *trace)
+{
+    sched->trace = trace;
+}
+void timeslice_trace_attach(timeslice_trace_s *trace)
+{
+    timeslice_trace_attach_r(local, trace);
+}
+#endif /* TIMESLICE_TRACE */
+
+#if defined(TIMESLICE_HIST)
+void timeslice_hist_attach_r(timeslice_sched_s *sched, timeslice_hist_s *hist)
+{
+    sched->hist = hist;
+}
+void timeslice_hist_attach(timeslice_hist_s *hist)
+{
+    timeslice_hist_attach_r(local, hist);
+}
+#endif /* TIMESLICE_HIST */
+
+#if defined(TIMESLICE_PROFILE)
+void timeslice_prof(const timeslice_s *ctx, timeslice_prof_s *prof)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    *prof = *ctx->prof;
+    prof->missed = ATOMIC_LOAD(ctx->prof->missed);
+}
+
+void timeslice_prof_reset(timeslice_s *ctx)
+{
+    ctx = ctx ? ctx : timeslice_current_;
+    prof_reset(ctx->prof);
+}
+
+void timeslice_prof_each_r(const timeslice_sched_s *sched,
+                           void (*each)(const timeslice_s *, const timeslice_prof_s *, void *), void *argv)
+{
+    timeslice_prof_s prof;
+    const timeslice_s *ctx;
+    const list_s *node;
+    list_foreach(node, sched->running)
+    {
+        ctx = list_entry(node, const timeslice_s, node);
+        timeslice_prof(ctx, &prof);
+        each(ctx, &prof, argv);
+    }
+}
+void timeslice_prof_each(void (*each)(const timeslice_s *, const timeslice_prof_s *, void *), void *argv)
+{
+    timeslice_prof_each_r(local, each, argv);
 }
+#endif /* TIMESLICE_PROFILE */
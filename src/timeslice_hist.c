@@ -0,0 +1,108 @@
+/*!
+ @file timeslice_hist.c
+ @brief Latency histogram with log-linear buckets.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_hist.h"
+#include "atomic.h"
+
+#define TIMESLICE_HIST_SLOT (1U << TIMESLICE_HIST_BITS)
+
+static inline unsigned int timeslice_hist_index_(uint64_t value)
+{
+    unsigned int shift;
+    if (value < 2 * TIMESLICE_HIST_SLOT)
+    {
+        return (unsigned int)value;
+    }
+    if (value >> TIMESLICE_HIST_MAX)
+    {
+        return TIMESLICE_HIST_SIZE - 1;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    shift = 63U - (unsigned int)__builtin_clzll(value) - TIMESLICE_HIST_BITS;
+#else /* !__GNUC__ */
+    for (shift = 0; value >> (shift + TIMESLICE_HIST_BITS + 1); ++shift)
+    {
+    }
+#endif /* __GNUC__ */
+    return (shift << TIMESLICE_HIST_BITS) + (unsigned int)(value >> shift);
+}
+
+/* the largest value that falls into a bucket */
+static inline uint64_t timeslice_hist_value_(unsigned int index)
+{
+    unsigned int shift;
+    if (index < 2 * TIMESLICE_HIST_SLOT)
+    {
+        return index;
+    }
+    shift = (index >> TIMESLICE_HIST_BITS) - 1;
+    return ((uint64_t)(index - (shift << TIMESLICE_HIST_BITS)) << shift) + ((uint64_t)1 << shift) - 1;
+}
+
+void timeslice_hist_reset(timeslice_hist_s *ctx)
+{
+    for (unsigned int i = 0; i != TIMESLICE_HIST_SIZE; ++i)
+    {
+        ATOMIC_STORE(ctx->count[i], 0);
+    }
+    ATOMIC_STORE(ctx->total, 0);
+    ATOMIC_STORE(ctx->max, 0);
+}
+
+void timeslice_hist_add(timeslice_hist_s *ctx, uint64_t value)
+{
+    ATOMIC_ADD(ctx->count[timeslice_hist_index_(value)], 1);
+    ATOMIC_ADD(ctx->total, 1);
+#if defined(TIMESLICE_ATOMIC)
+    for (uint64_t max = ATOMIC_LOAD(ctx->max); value > max;)
+    {
+        if (ATOMIC_CAS(ctx->max, max, value))
+        {
+            break;
+        }
+    }
+#else /* !TIMESLICE_ATOMIC */
+    if (value > ctx->max)
+    {
+        ctx->max = value;
+    }
+#endif /* TIMESLICE_ATOMIC */
+}
+
+uint64_t timeslice_hist_quantile(const timeslice_hist_s *ctx, double q)
+{
+    uint64_t total = ATOMIC_LOAD(ctx->total);
+    uint64_t max = ATOMIC_LOAD(ctx->max);
+    uint64_t rank, value, count = 0;
+    if (total == 0)
+    {
+        return 0;
+    }
+    q = q < 0 ? 0 : q > 1 ? 1 : q;
+    rank = (uint64_t)(q * (double)total + 0.5);
+    rank = rank ? rank : 1;
+    for (unsigned int i = 0; i != TIMESLICE_HIST_SIZE; ++i)
+    {
+        count += ATOMIC_LOAD(ctx->count[i]);
+        if (count >= rank)
+        {
+            /* the last bucket holds all the values beyond its range */
+            value = i != TIMESLICE_HIST_SIZE - 1 ? timeslice_hist_value_(i) : max;
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+uint64_t timeslice_hist_max(const timeslice_hist_s *ctx)
+{
+    return ATOMIC_LOAD(ctx->max);
+}
+
+uint64_t timeslice_hist_total(const timeslice_hist_s *ctx)
+{
+    return ATOMIC_LOAD(ctx->total);
+}
@@ -0,0 +1,106 @@
+/*!
+ @file timeslice_pool.c
+ @brief Multi-core executor for timeslice with per-worker deques and work stealing.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_pool.h"
+#include "atomic.h"
+
+#define TIMESLICE_DEQUE_MASK (TIMESLICE_DEQUE - 1)
+#define TIMESLICE_DEQUE_SIZE(b, t) ((ptrdiff_t)((b) - (t)))
+
+/* the owner pushes to the bottom of its deque */
+static int timeslice_deque_push_(timeslice_deque_s *deque, timeslice_s *ctx)
+{
+    size_t bottom = deque->bottom;
+    if (TIMESLICE_DEQUE_SIZE(bottom, ATOMIC_LOAD(deque->top)) >= TIMESLICE_DEQUE)
+    {
+        return 0;
+    }
+    ATOMIC_STORE(deque->slot[bottom & TIMESLICE_DEQUE_MASK], ctx);
+    ATOMIC_STORE(deque->bottom, bottom + 1);
+    return 1;
+}
+
+/* the owner pops from the bottom of its deque */
+static timeslice_s *timeslice_deque_pop_(timeslice_deque_s *deque)
+{
+    timeslice_s *ctx = 0;
+    size_t bottom = deque->bottom - 1, top;
+    ATOMIC_STORE(deque->bottom, bottom);
+    ATOMIC_FENCE();
+    top = ATOMIC_LOAD(deque->top);
+    if (TIMESLICE_DEQUE_SIZE(bottom, top) >= 0)
+    {
+        ctx = ATOMIC_LOAD(deque->slot[bottom & TIMESLICE_DEQUE_MASK]);
+        if (bottom != top)
+        {
+            return ctx;
+        }
+        /* the last task races with the thieves */
+        if (!ATOMIC_CAS(deque->top, top, top + 1))
+        {
+            ctx = 0;
+        }
+    }
+    ATOMIC_STORE(deque->bottom, bottom + 1);
+    return ctx;
+}
+
+/* the thieves steal from the top of a deque */
+static timeslice_s *timeslice_deque_steal_(timeslice_deque_s *deque)
+{
+    timeslice_s *ctx;
+    size_t top = ATOMIC_LOAD(deque->top), bottom;
+    ATOMIC_FENCE();
+    bottom = ATOMIC_LOAD(deque->bottom);
+    if (TIMESLICE_DEQUE_SIZE(bottom, top) <= 0)
+    {
+        return 0;
+    }
+    ctx = ATOMIC_LOAD(deque->slot[top & TIMESLICE_DEQUE_MASK]);
+    return ATOMIC_CAS(deque->top, top, top + 1) ? ctx : 0;
+}
+
+void timeslice_pool_init(timeslice_pool_s *pool, timeslice_sched_s *sched, timeslice_deque_s *deque, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        deque[i].top = 0;
+        deque[i].bottom = 0;
+    }
+    pool->sched = sched;
+    pool->deque = deque;
+    pool->count = count;
+    pool->pull = 0;
+}
+
+size_t timeslice_pool_work(timeslice_pool_s *pool, size_t id)
+{
+    size_t n = 0, i;
+    timeslice_s *ctx;
+    timeslice_deque_s *deque = pool->deque + id;
+    for (;;)
+    {
+        ctx = timeslice_deque_pop_(deque);
+        /* the scheduler is pulled by one worker at a time, and one task at a time to keep its order */
+        if (!ctx && !ATOMIC_XCHG(pool->pull, 1))
+        {
+            ctx = timeslice_pull_r(pool->sched);
+            ATOMIC_STORE(pool->pull, 0);
+        }
+        for (i = 1; !ctx && i != pool->count; ++i)
+        {
+            ctx = timeslice_deque_steal_(pool->deque + (id + i) % pool->count);
+        }
+        if (!ctx)
+        {
+            return n;
+        }
+        /* a task that became due again while executing goes back to the deque */
+        for (++n; timeslice_call_r(pool->sched, ctx) && !timeslice_deque_push_(deque, ctx); ++n)
+        {
+        }
+    }
+}
@@ -0,0 +1,99 @@
+/*!
+ @file timeslice_sim.c
+ @brief Virtual-time simulation driver for timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_sim.h"
+
+/* the execution of a task takes its cost, and it responds at the end */
+static void timeslice_sim_exec_(void *argv)
+{
+    timeslice_sim_task_s *task = (timeslice_sim_task_s *)argv;
+    timeslice_sim_s *sim = task->sim;
+    uint64_t release = (uint64_t)(task->ctx->stamp - sim->base) * sim->period;
+    uint64_t cost = sim->cost ? sim->cost(task->ctx, sim->argv) : 0;
+    uint64_t resp;
+    task->exec(task->argv);
+    sim->now += cost;
+    sim->busy += cost;
+    resp = sim->now - release;
+    ++task->count;
+    task->busy += cost;
+    task->resp_sum += resp;
+    task->resp_min = resp < task->resp_min ? resp : task->resp_min;
+    task->resp_max = resp > task->resp_max ? resp : task->resp_max;
+}
+
+void timeslice_sim_init(timeslice_sim_s *sim, timeslice_sched_s *sched, uint64_t period,
+                        uint64_t (*cost)(const timeslice_s *, void *), void *argv)
+{
+    sim->sched = sched;
+    sim->cost = cost;
+    sim->argv = argv;
+    sim->period = period;
+    sim->now = 0;
+    sim->busy = 0;
+    sim->base = timeslice_now_r(sched);
+}
+
+void timeslice_sim_add(timeslice_sim_s *sim, timeslice_sim_task_s *task, timeslice_s *ctx)
+{
+    task->sim = sim;
+    task->ctx = ctx;
+    task->exec = ctx->exec;
+    task->argv = ctx->argv;
+    task->count = 0;
+    task->busy = 0;
+    task->resp_min = UINT64_MAX;
+    task->resp_max = 0;
+    task->resp_sum = 0;
+    timeslice_set_exec(ctx, timeslice_sim_exec_);
+    timeslice_set_argv(ctx, task);
+}
+
+void timeslice_sim_del(timeslice_sim_task_s *task)
+{
+    timeslice_set_exec(task->ctx, task->exec);
+    timeslice_set_argv(task->ctx, task->argv);
+}
+
+uint64_t timeslice_sim_run(timeslice_sim_s *sim, uint64_t span)
+{
+    size_t elapsed, tick;
+    uint64_t end = sim->now + span;
+    while (sim->now < end)
+    {
+        timeslice_exec_r(sim->sched);
+        /* the ticks that elapsed while executing */
+        tick = (size_t)(sim->now / sim->period) + sim->base;
+        elapsed = tick - timeslice_now_r(sim->sched);
+        if (elapsed == 0)
+        {
+            /* idle until the next expiry, or until the end if nothing is armed */
+            elapsed = timeslice_next_expiry_r(sim->sched);
+            if (elapsed == 0 || (uint64_t)(tick - sim->base + elapsed) * sim->period >= end)
+            {
+                tick = (size_t)(end / sim->period) + sim->base;
+                elapsed = tick - timeslice_now_r(sim->sched);
+                sim->now = end;
+            }
+            else
+            {
+                sim->now = (uint64_t)(tick - sim->base + elapsed) * sim->period;
+            }
+        }
+        timeslice_advance_r(sim->sched, elapsed);
+    }
+    return sim->now;
+}
+
+double timeslice_sim_util(const timeslice_sim_s *sim)
+{
+    return sim->now ? (double)sim->busy / (double)sim->now : 0;
+}
+
+double timeslice_sim_task_util(const timeslice_sim_task_s *task)
+{
+    return task->sim->now ? (double)task->busy / (double)task->sim->now : 0;
+}
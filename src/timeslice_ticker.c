@@ -0,0 +1,187 @@
+/*!
+ @file timeslice_ticker.c
+ @brief Linux tick source that drives timeslice from timerfd or clock_nanosleep.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#if defined(__linux__)
+#define _GNU_SOURCE
+#include "timeslice_ticker.h"
+#include "atomic.h"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+#include <time.h>
+
+#define NSEC_PER_SEC 1000000000ULL
+
+static inline uint64_t timeslice_ticker_now_(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static inline void timeslice_ticker_ts_(struct timespec *ts, uint64_t ns)
+{
+    ts->tv_sec = (time_t)(ns / NSEC_PER_SEC);
+    ts->tv_nsec = (long)(ns % NSEC_PER_SEC);
+}
+
+/* record a wakeup that is late by some nanoseconds and applies some ticks, all but one of them missed */
+static void timeslice_ticker_record_(timeslice_ticker_s *ctx, uint64_t late, uint64_t ticks)
+{
+    timeslice_ticker_stat_s *stat = ctx->stat;
+    uint64_t wakeups = ATOMIC_LOAD(stat->wakeups);
+    if (wakeups == 0 || late < ATOMIC_LOAD(stat->jitter_min))
+    {
+        ATOMIC_STORE(stat->jitter_min, late);
+    }
+    if (late > ATOMIC_LOAD(stat->jitter_max))
+    {
+        ATOMIC_STORE(stat->jitter_max, late);
+    }
+    ATOMIC_STORE(stat->jitter_sum, ATOMIC_LOAD(stat->jitter_sum) + late);
+    ATOMIC_STORE(stat->overruns, ATOMIC_LOAD(stat->overruns) + ticks - 1);
+    ATOMIC_STORE(stat->ticks, ATOMIC_LOAD(stat->ticks) + ticks);
+    ATOMIC_STORE(stat->wakeups, wakeups + 1);
+}
+
+static void *timeslice_ticker_nanosleep_(timeslice_ticker_s *ctx)
+{
+    struct timespec ts;
+    uint64_t now, late, ticks;
+    uint64_t next = timeslice_ticker_now_() + ctx->period;
+    while (!ATOMIC_LOAD(ctx->stop))
+    {
+        timeslice_ticker_ts_(&ts, next);
+        if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0))
+        {
+            continue;
+        }
+        now = timeslice_ticker_now_();
+        late = now > next ? now - next : 0;
+        /* the deadlines that passed while sleeping become catch-up ticks */
+        ticks = late / ctx->period + 1;
+        timeslice_advance_r(ctx->sched, (size_t)ticks);
+        timeslice_ticker_record_(ctx, late, ticks);
+        next += ticks * ctx->period;
+    }
+    return ctx;
+}
+
+static void *timeslice_ticker_timerfd_(timeslice_ticker_s *ctx)
+{
+    uint64_t ticks, now, next, late;
+    struct itimerspec its;
+    timeslice_ticker_ts_(&its.it_value, ctx->period);
+    its.it_interval = its.it_value;
+    next = timeslice_ticker_now_() + ctx->period;
+    if (timerfd_settime(ctx->fd, 0, &its, 0))
+    {
+        return 0;
+    }
+    while (!ATOMIC_LOAD(ctx->stop))
+    {
+        if (read(ctx->fd, &ticks, sizeof(ticks)) != (ssize_t)sizeof(ticks) || ticks == 0)
+        {
+            continue;
+        }
+        now = timeslice_ticker_now_();
+        late = now > next ? now - next : 0;
+        /* the expiration count already includes the expirations that were missed */
+        timeslice_advance_r(ctx->sched, (size_t)ticks);
+        timeslice_ticker_record_(ctx, late, ticks);
+        next += ticks * ctx->period;
+    }
+    return ctx;
+}
+
+static void *timeslice_ticker_(void *arg)
+{
+    timeslice_ticker_s *ctx = (timeslice_ticker_s *)arg;
+    if (ctx->mode == TIMESLICE_TICKER_TIMERFD)
+    {
+        return timeslice_ticker_timerfd_(ctx);
+    }
+    return timeslice_ticker_nanosleep_(ctx);
+}
+
+int timeslice_ticker_start(timeslice_ticker_s *ctx, timeslice_sched_s *sched, uint64_t period, int mode, int cpu)
+{
+    int err;
+    cpu_set_t set;
+    pthread_attr_t attr;
+    ctx->sched = sched;
+    ctx->stat->ticks = 0;
+    ctx->stat->wakeups = 0;
+    ctx->stat->overruns = 0;
+    ctx->stat->jitter_min = 0;
+    ctx->stat->jitter_max = 0;
+    ctx->stat->jitter_sum = 0;
+    ctx->period = period ? period : 1;
+    ctx->mode = mode;
+    ctx->cpu = cpu;
+    ctx->stop = 0;
+    ctx->fd = -1;
+    ctx->started = 0;
+    if (mode == TIMESLICE_TICKER_TIMERFD)
+    {
+        ctx->fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (ctx->fd < 0)
+        {
+            return errno;
+        }
+    }
+    err = pthread_attr_init(&attr);
+    if (err == 0)
+    {
+        if (cpu >= 0)
+        {
+            CPU_ZERO(&set);
+            CPU_SET((size_t)cpu, &set);
+            err = pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+        }
+        if (err == 0)
+        {
+            err = pthread_create(&ctx->thread, &attr, timeslice_ticker_, ctx);
+        }
+        pthread_attr_destroy(&attr);
+    }
+    if (err && ctx->fd >= 0)
+    {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+    ctx->started = !err;
+    return err;
+}
+
+void timeslice_ticker_stop(timeslice_ticker_s *ctx)
+{
+    if (!ctx->started)
+    {
+        return;
+    }
+    ctx->started = 0;
+    ATOMIC_STORE(ctx->stop, 1);
+    pthread_join(ctx->thread, 0);
+    if (ctx->fd >= 0)
+    {
+        close(ctx->fd);
+        ctx->fd = -1;
+    }
+}
+
+void timeslice_ticker_stat(const timeslice_ticker_s *ctx, timeslice_ticker_stat_s *stat)
+{
+    stat->wakeups = ATOMIC_LOAD(ctx->stat->wakeups);
+    stat->ticks = ATOMIC_LOAD(ctx->stat->ticks);
+    stat->overruns = ATOMIC_LOAD(ctx->stat->overruns);
+    stat->jitter_min = ATOMIC_LOAD(ctx->stat->jitter_min);
+    stat->jitter_max = ATOMIC_LOAD(ctx->stat->jitter_max);
+    stat->jitter_sum = ATOMIC_LOAD(ctx->stat->jitter_sum);
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,49 @@
+/*!
+ @file timeslice_trace.c
+ @brief Binary trace of the events of a timeslice scheduler.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_trace.h"
+#include "atomic.h"
+#include "clock.h"
+
+void timeslice_trace_init(timeslice_trace_s *ctx, timeslice_trace_rec_s *ring, size_t count)
+{
+    ctx->ring = ring;
+    ctx->mask = count - 1;
+    ctx->tail = 0;
+}
+
+void timeslice_trace_put(timeslice_trace_s *ctx, unsigned int event, const void *task, size_t arg)
+{
+    timeslice_trace_rec_s *rec;
+    /* each writer claims its own slot, the oldest record is overwritten */
+#if defined(TIMESLICE_ATOMIC)
+    size_t tail = ATOMIC_ADD(ctx->tail, 1);
+#else /* !TIMESLICE_ATOMIC */
+    size_t tail = ctx->tail++;
+#endif /* TIMESLICE_ATOMIC */
+    rec = ctx->ring + (tail & ctx->mask);
+    rec->time = clock_ns();
+    rec->task = (uint32_t)(size_t)task;
+    rec->event = (uint16_t)event;
+    rec->arg = (uint16_t)(arg < 0xFFFF ? arg : 0xFFFF);
+}
+
+size_t timeslice_trace_read(const timeslice_trace_s *ctx, timeslice_trace_rec_s *rec, size_t count)
+{
+    size_t tail = ATOMIC_LOAD(ctx->tail);
+    size_t size = tail < ctx->mask + 1 ? tail : ctx->mask + 1;
+    size = size < count ? size : count;
+    for (size_t head = tail - size; head != tail; ++head)
+    {
+        *rec++ = ctx->ring[head & ctx->mask];
+    }
+    return size;
+}
+
+void timeslice_trace_reset(timeslice_trace_s *ctx)
+{
+    ATOMIC_STORE(ctx->tail, 0);
+}
@@ -0,0 +1,280 @@
+/*!
+ @file vtimeslice.c
+ @brief Cooperative timeslice scheduler implementation with a structure-of-arrays timer table.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "vtimeslice.h"
+
+#if !defined(VTIMESLICE_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VTIMESLICE_SSE2
+#include <emmintrin.h>
+#endif /* __SSE2__ */
+#if defined(__AVX2__)
+#define VTIMESLICE_AVX2 /* built for the target */
+#include <immintrin.h>
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+/* the AVX2 lanes are built for the target, and chosen at run time */
+#define VTIMESLICE_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif /* __AVX2__ */
+#endif /* VTIMESLICE_SCALAR */
+
+#define BIT(map, id) ((map)[(id) >> 6] & ((uint64_t)1 << ((id)&63)))
+#define SET(map, id) ((map)[(id) >> 6] |= ((uint64_t)1 << ((id)&63)))
+#define CLR(map, id) ((map)[(id) >> 6] &= ~((uint64_t)1 << ((id)&63)))
+
+#define VTIMESLICE_MAX 0xFFFFFFFFU
+
+static inline uint32_t vtimeslice_clamp_(size_t value)
+{
+    return value < VTIMESLICE_MAX ? (uint32_t)value : VTIMESLICE_MAX;
+}
+
+static inline unsigned int vtimeslice_ctz_(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned int)__builtin_ctzll(x);
+#else /* !__GNUC__ */
+    unsigned int n = 0;
+    for (; !(x & 1); x >>= 1)
+    {
+        ++n;
+    }
+    return n;
+#endif /* __GNUC__ */
+}
+
+/*
+ The lanes count down the 64 timers of a word of the bitmap. A zero timer is idle, and the
+ timers that reach zero are reloaded from the slices and returned as the mask of due tasks.
+*/
+
+static uint64_t vtimeslice_lane_(uint32_t *timer, const uint32_t *slice)
+{
+    uint64_t due = 0;
+    for (unsigned int i = 0; i != 64; ++i)
+    {
+        if (timer[i] && !--timer[i])
+        {
+            timer[i] = slice[i];
+            due |= (uint64_t)1 << i;
+        }
+    }
+    return due;
+}
+
+#if defined(VTIMESLICE_SSE2)
+static uint64_t vtimeslice_lane_sse2_(uint32_t *timer, const uint32_t *slice)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t due = 0;
+    for (unsigned int i = 0; i != 64; i += 4)
+    {
+        __m128i t = _mm_loadu_si128((const __m128i *)(timer + i));
+        __m128i idle = _mm_cmpeq_epi32(t, zero);
+        __m128i mask;
+        /* the busy lanes add all ones, which is minus one */
+        t = _mm_add_epi32(t, _mm_andnot_si128(idle, _mm_cmpeq_epi32(zero, zero)));
+        mask = _mm_andnot_si128(idle, _mm_cmpeq_epi32(t, zero));
+        t = _mm_or_si128(_mm_and_si128(mask, _mm_loadu_si128((const __m128i *)(slice + i))), _mm_andnot_si128(mask, t));
+        _mm_storeu_si128((__m128i *)(timer + i), t);
+        due |= (uint64_t)(unsigned int)_mm_movemask_ps(_mm_castsi128_ps(mask)) << i;
+    }
+    return due;
+}
+#endif /* VTIMESLICE_SSE2 */
+
+#if defined(VTIMESLICE_AVX2)
+VTIMESLICE_AVX2 static uint64_t vtimeslice_lane_avx2_(uint32_t *timer, const uint32_t *slice)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t due = 0;
+    for (unsigned int i = 0; i != 64; i += 8)
+    {
+        __m256i t = _mm256_loadu_si256((const __m256i *)(timer + i));
+        __m256i idle = _mm256_cmpeq_epi32(t, zero);
+        __m256i mask;
+        t = _mm256_add_epi32(t, _mm256_andnot_si256(idle, _mm256_cmpeq_epi32(zero, zero)));
+        mask = _mm256_andnot_si256(idle, _mm256_cmpeq_epi32(t, zero));
+        t = _mm256_blendv_epi8(t, _mm256_loadu_si256((const __m256i *)(slice + i)), mask);
+        _mm256_storeu_si256((__m256i *)(timer + i), t);
+        due |= (uint64_t)(unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(mask)) << i;
+    }
+    return due;
+}
+#endif /* VTIMESLICE_AVX2 */
+
+static uint64_t (*vtimeslice_lane)(uint32_t *, const uint32_t *) = vtimeslice_lane_;
+
+void vtimeslice_sched_init(vtimeslice_sched_s *sched, void *memory, size_t count)
+{
+    size_t words = (count + 63) / 64;
+    count = words * 64;
+    sched->call = (vtimeslice_call_s *)memory;
+    sched->ready = (uint64_t *)(sched->call + count);
+    sched->join = sched->ready + words;
+    sched->once = sched->join + words;
+    sched->timer = (uint32_t *)(sched->once + words);
+    sched->slice = sched->timer + count;
+    sched->saved = sched->slice + count;
+    sched->count = count;
+    sched->counter = 0;
+    sched->ctx = 0;
+    for (size_t i = 0; i != count; ++i)
+    {
+        sched->call[i].exec = 0;
+        sched->call[i].argv = 0;
+        sched->timer[i] = 0;
+        sched->slice[i] = 0;
+        sched->saved[i] = 0;
+    }
+    for (size_t i = 0; i != words; ++i)
+    {
+        sched->ready[i] = 0;
+        sched->join[i] = 0;
+        sched->once[i] = 0;
+    }
+#if defined(VTIMESLICE_SSE2)
+    vtimeslice_lane = vtimeslice_lane_sse2_;
+#endif /* VTIMESLICE_SSE2 */
+#if defined(VTIMESLICE_AVX2) && defined(__AVX2__)
+    vtimeslice_lane = vtimeslice_lane_avx2_;
+#elif defined(VTIMESLICE_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        vtimeslice_lane = vtimeslice_lane_avx2_;
+    }
+#endif /* __AVX2__ */
+}
+
+size_t vtimeslice_self_r(const vtimeslice_sched_s *sched)
+{
+    return sched->ctx;
+}
+
+void vtimeslice_tick_r(vtimeslice_sched_s *sched)
+{
+    size_t words = sched->count / 64;
+    uint32_t *timer = sched->timer;
+    const uint32_t *slice = sched->slice;
+    for (size_t i = 0; i != words; ++i, timer += 64, slice += 64)
+    {
+        /* the timers of dropped tasks are parked in the saved array, so only joined tasks count down */
+        if (sched->join[i])
+        {
+            sched->ready[i] |= vtimeslice_lane(timer, slice);
+        }
+    }
+}
+
+void vtimeslice_exec_r(vtimeslice_sched_s *sched)
+{
+    size_t words = sched->count / 64;
+    for (size_t i = 0; i != words; ++i)
+    {
+        uint64_t ready = sched->ready[i];
+        sched->ready[i] = 0;
+        while (ready)
+        {
+            size_t id = i * 64 + vtimeslice_ctz_(ready);
+            ready &= ready - 1;
+            /* a task that is dropped by an earlier callback is skipped */
+            if (BIT(sched->join, id))
+            {
+                sched->ctx = id;
+                sched->call[id].exec(sched->call[id].argv);
+                if (BIT(sched->once, id))
+                {
+                    vtimeslice_drop_r(sched, id);
+                }
+            }
+        }
+    }
+}
+
+void vtimeslice_cron_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t slice)
+{
+    vtimeslice_drop_r(sched, id);
+    sched->slice[id] = vtimeslice_clamp_(slice);
+    sched->saved[id] = sched->slice[id];
+    sched->call[id].exec = exec;
+    sched->call[id].argv = argv;
+    CLR(sched->once, id);
+}
+
+void vtimeslice_once_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *), void *argv, size_t delay)
+{
+    vtimeslice_drop_r(sched, id);
+    sched->slice[id] = vtimeslice_clamp_(delay);
+    sched->saved[id] = sched->slice[id];
+    sched->call[id].exec = exec;
+    sched->call[id].argv = argv;
+    SET(sched->once, id);
+}
+
+void vtimeslice_set_exec_r(vtimeslice_sched_s *sched, size_t id, void (*exec)(void *))
+{
+    sched->call[id].exec = exec;
+}
+void vtimeslice_set_argv_r(vtimeslice_sched_s *sched, size_t id, void *argv)
+{
+    sched->call[id].argv = argv;
+}
+void vtimeslice_set_timer_r(vtimeslice_sched_s *sched, size_t id, size_t timer)
+{
+    if (BIT(sched->join, id))
+    {
+        sched->timer[id] = vtimeslice_clamp_(timer);
+    }
+    else
+    {
+        sched->saved[id] = vtimeslice_clamp_(timer);
+    }
+}
+void vtimeslice_set_slice_r(vtimeslice_sched_s *sched, size_t id, size_t slice)
+{
+    sched->slice[id] = vtimeslice_clamp_(slice);
+}
+
+void vtimeslice_join_r(vtimeslice_sched_s *sched, size_t id)
+{
+    if (!BIT(sched->join, id))
+    {
+        SET(sched->join, id);
+        sched->timer[id] = sched->saved[id];
+        ++sched->counter;
+    }
+}
+
+void vtimeslice_drop_r(vtimeslice_sched_s *sched, size_t id)
+{
+    if (BIT(sched->join, id))
+    {
+        CLR(sched->join, id);
+        CLR(sched->ready, id);
+        sched->saved[id] = sched->timer[id];
+        sched->timer[id] = 0;
+        --sched->counter;
+    }
+}
+
+int vtimeslice_exist_r(const vtimeslice_sched_s *sched, size_t id)
+{
+    return BIT(sched->join, id) != 0;
+}
+
+size_t vtimeslice_timer_r(const vtimeslice_sched_s *sched, size_t id)
+{
+    return BIT(sched->join, id) ? sched->timer[id] : sched->saved[id];
+}
+size_t vtimeslice_slice_r(const vtimeslice_sched_s *sched, size_t id)
+{
+    return sched->slice[id];
+}
+size_t vtimeslice_count_r(const vtimeslice_sched_s *sched)
+{
+    return sched->counter;
+}
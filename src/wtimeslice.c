@@ -0,0 +1,255 @@
+/*!
+ @file wtimeslice.c
+ @brief Cooperative timeslice scheduler implementation based on hierarchical timing wheel.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "wtimeslice.h"
+
+#define BIT(ctx, bit) ((ctx)->stat & (bit))
+#define SET(ctx, bit) ((ctx)->stat |= (bit))
+#define CLR(ctx, bit) ((ctx)->stat &= ~(bit))
+#define HAS(ctx, bit) (((ctx)->stat & (bit)) == (bit))
+#define NOT(ctx, bit) (((ctx)->stat & (bit)) != (bit))
+
+#define WTIMESLICE_SLOT (1 << WTIMESLICE_BITS)
+#define WTIMESLICE_MASK (WTIMESLICE_SLOT - 1)
+#define WTIMESLICE_SPAN ((size_t)1 << (WTIMESLICE_BITS * WTIMESLICE_LEVEL))
+
+/*!
+ @brief timeslice flags
+*/
+enum
+{
+    WTIMESLICE_CTRL = 0x000F, //!< Register for control
+    WTIMESLICE_EXEC = 1 << 0, //!< Bit that the task needs to execute
+    WTIMESLICE_JOIN = 1 << 1, //!< Bit which the task has been joined
+    WTIMESLICE_STAT = 0x00F0, //!< Register for status
+    WTIMESLICE_LOCK = 1 << 4, //!< Bit that the task has been locked
+    WTIMESLICE_TYPE = 0x0F00, //!< Register for type
+    WTIMESLICE_CRON = 1 << 8, //!< Bit for the cron task
+    WTIMESLICE_ONCE = 1 << 9, //!< Bit for the once task
+};
+
+static struct
+{
+    list_s wheel[WTIMESLICE_LEVEL][WTIMESLICE_SLOT];
+    list_s ready[1];
+    wtimeslice_s *ctx;
+    size_t counter;
+    size_t now;
+} local[1] = {{
+    {{{0, 0}}},
+    {{local->ready, local->ready}},
+    0,
+    0,
+    0,
+}};
+
+/* the slots of the timing wheel are initialized on first use */
+#define WTIMESLICE_INIT() (local->wheel[0]->next != 0)
+
+static void wtimeslice_init_(void)
+{
+    for (unsigned int level = 0; level != WTIMESLICE_LEVEL; ++level)
+    {
+        for (unsigned int slot = 0; slot != WTIMESLICE_SLOT; ++slot)
+        {
+            list_init(local->wheel[level] + slot);
+        }
+    }
+}
+
+/* hash the task into the slot of the level that covers its expiry */
+static void wtimeslice_hash_(wtimeslice_s *ctx)
+{
+    unsigned int level = 0;
+    size_t expire = ctx->expire;
+    size_t delta = expire - local->now;
+    if (delta >= WTIMESLICE_SPAN)
+    {
+        delta = WTIMESLICE_SPAN - 1;
+        expire = local->now + delta;
+    }
+    while (delta >> (WTIMESLICE_BITS * (level + 1)))
+    {
+        ++level;
+    }
+    expire >>= WTIMESLICE_BITS * level;
+    list_add(local->wheel[level] + (expire & WTIMESLICE_MASK), ctx->node);
+}
+
+static inline void wtimeslice_arm_(wtimeslice_s *ctx, size_t timer)
+{
+    if (timer)
+    {
+        ctx->expire = local->now + timer;
+        wtimeslice_hash_(ctx);
+    }
+}
+
+/* rehash a slot of the upper level into the lower levels */
+static void wtimeslice_cascade_(list_s *slot)
+{
+    list_s *node, *next;
+    list_forsafe(node, next, slot)
+    {
+        list_del(node);
+        wtimeslice_hash_(list_entry(node, wtimeslice_s, node));
+    }
+}
+
+void wtimeslice_tick(void)
+{
+    size_t now;
+    list_s *slot;
+    wtimeslice_s *ctx;
+    list_s *node, *next;
+    if (!WTIMESLICE_INIT())
+    {
+        wtimeslice_init_();
+    }
+    now = ++local->now;
+    for (unsigned int level = 1; level != WTIMESLICE_LEVEL; ++level)
+    {
+        if (now & WTIMESLICE_MASK)
+        {
+            break;
+        }
+        now >>= WTIMESLICE_BITS;
+        wtimeslice_cascade_(local->wheel[level] + (now & WTIMESLICE_MASK));
+    }
+    slot = local->wheel[0] + (local->now & WTIMESLICE_MASK);
+    list_forsafe(node, next, slot)
+    {
+        ctx = list_entry(node, wtimeslice_s, node);
+        list_del(ctx->node);
+        if (NOT(ctx, WTIMESLICE_EXEC))
+        {
+            SET(ctx, WTIMESLICE_EXEC);
+            list_add(local->ready, ctx->ready);
+        }
+        if (BIT(ctx, WTIMESLICE_CRON))
+        {
+            wtimeslice_arm_(ctx, ctx->slice);
+        }
+    }
+}
+
+void wtimeslice_exec(void)
+{
+    while (list_used(local->ready))
+    {
+        local->ctx = list_entry(local->ready->next, wtimeslice_s, ready);
+        list_del(local->ctx->ready);
+        CLR(local->ctx, WTIMESLICE_EXEC);
+        local->ctx->exec(local->ctx->argv);
+        if (BIT(local->ctx, WTIMESLICE_ONCE))
+        {
+            wtimeslice_drop(local->ctx);
+        }
+    }
+}
+
+void wtimeslice_cron(wtimeslice_s *ctx, void (*exec)(void *), void *argv, size_t slice)
+{
+    list_init(ctx->node);
+    list_init(ctx->ready);
+    ctx->slice = slice;
+    ctx->timer = slice;
+    ctx->expire = 0;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = WTIMESLICE_CRON;
+}
+
+void wtimeslice_once(wtimeslice_s *ctx, void (*exec)(void *), void *argv, size_t delay)
+{
+    list_init(ctx->node);
+    list_init(ctx->ready);
+    ctx->slice = delay;
+    ctx->timer = delay;
+    ctx->expire = 0;
+    ctx->exec = exec;
+    ctx->argv = argv;
+    ctx->stat = WTIMESLICE_ONCE;
+}
+
+void wtimeslice_set_exec(wtimeslice_s *ctx, void (*exec)(void *))
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->exec = exec;
+}
+void wtimeslice_set_argv(wtimeslice_s *ctx, void *argv)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->argv = argv;
+}
+void wtimeslice_set_timer(wtimeslice_s *ctx, size_t timer)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->timer = timer;
+    if (HAS(ctx, WTIMESLICE_JOIN))
+    {
+        list_del(ctx->node);
+        wtimeslice_arm_(ctx, timer);
+    }
+}
+void wtimeslice_set_slice(wtimeslice_s *ctx, size_t slice)
+{
+    ctx = ctx ? ctx : local->ctx;
+    ctx->slice = slice;
+}
+
+void wtimeslice_join(wtimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (NOT(ctx, WTIMESLICE_JOIN))
+    {
+        if (!WTIMESLICE_INIT())
+        {
+            wtimeslice_init_();
+        }
+        SET(ctx, WTIMESLICE_JOIN);
+        wtimeslice_arm_(ctx, ctx->timer);
+        ++local->counter;
+    }
+}
+
+void wtimeslice_drop(wtimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (HAS(ctx, WTIMESLICE_JOIN))
+    {
+        ctx->timer = wtimeslice_timer(ctx);
+        list_del(ctx->node);
+        list_del(ctx->ready);
+        CLR(ctx, WTIMESLICE_CTRL);
+        --local->counter;
+    }
+}
+
+int wtimeslice_exist(const wtimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return HAS(ctx, WTIMESLICE_JOIN);
+}
+
+size_t wtimeslice_timer(const wtimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    if (NOT(ctx, WTIMESLICE_JOIN))
+    {
+        return ctx->timer;
+    }
+    return list_used(ctx->node) ? ctx->expire - local->now : 0;
+}
+size_t wtimeslice_slice(const wtimeslice_s *ctx)
+{
+    ctx = ctx ? ctx : local->ctx;
+    return ctx->slice;
+}
+size_t wtimeslice_count(void)
+{
+    return local->counter;
+}
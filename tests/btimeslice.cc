@@ -0,0 +1,260 @@
+/*!
+ @file btimeslice.cc
+ @brief Tesing cooperative scheduler timeslice with tasks grouped by period.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "btimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[5] = {0};
+static btimeslice_s btimeslice[6];
+static btimeslice_s crowd[100];
+static size_t count[100] = {0};
+static const size_t slice[5] = {10, 63, 64, 4097, 60000};
+static const size_t period[4] = {1, 10, 100, 1000};
+
+static void btimeslice1_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 0;
+    if (++*p % 2 == 0)
+    {
+        btimeslice_drop(btimeslice + 0);
+        btimeslice_drop(btimeslice + 0);
+    }
+}
+
+static void btimeslice2_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 1;
+    if (++*p % 2 == 0)
+    {
+        btimeslice_join(btimeslice + 0);
+        btimeslice_join(btimeslice + 0);
+    }
+}
+
+static void btimeslice3_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 2);
+}
+
+static void btimeslice4_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 3);
+}
+
+static void btimeslice5_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 4);
+}
+
+static void btimeslice6_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static void btimeslice7_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+/* a scheduler with a pool too small for its periods counts the rest down on their own */
+static void btimeslice_pool(void)
+{
+    btimeslice_sched_s sched[1];
+    btimeslice_bucket_s bucket[2];
+    btimeslice_s task[4];
+    size_t hits[4] = {0};
+    btimeslice_sched_init(sched, bucket, 2);
+    for (size_t i = 0; i != 4; ++i)
+    {
+        btimeslice_cron(task + i, btimeslice7_exec, hits + i, period[i]);
+        btimeslice_join_r(sched, task + i);
+    }
+    if (btimeslice_bucket_r(sched) != 2)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (size_t n = 0; n != 3000; ++n)
+    {
+        btimeslice_tick_r(sched);
+        btimeslice_exec_r(sched);
+    }
+    for (size_t i = 0; i != 4; ++i)
+    {
+        if (hits[i] != 3000 / period[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, hits[i]);
+            status = 1;
+        }
+        btimeslice_drop_r(sched, task + i);
+    }
+    if (btimeslice_bucket_r(sched) != 0 || btimeslice_count_r(sched) != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+
+static size_t burst = 0;
+static void btimeslice8_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+    ++burst;
+}
+
+/* the staggered joins spread the tasks of harmonic periods over the phases of their slices */
+static void btimeslice_stagger(void)
+{
+    btimeslice_sched_s sched[1];
+    btimeslice_bucket_s bucket[64];
+    btimeslice_s task[150];
+    size_t hits[150] = {0};
+    size_t most = 0;
+    btimeslice_sched_init(sched, bucket, 64);
+    btimeslice_set_stagger_r(sched, 1);
+    for (size_t i = 0; i != 150; ++i)
+    {
+        btimeslice_cron(task + i, btimeslice8_exec, hits + i, i < 100 ? 10 : 20);
+        btimeslice_join_r(sched, task + i);
+        if (btimeslice_timer_r(sched, task + i) == 0 || btimeslice_timer_r(sched, task + i) > btimeslice_slice(task + i))
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+    }
+    for (size_t n = 0; n != 200; ++n)
+    {
+        burst = 0;
+        btimeslice_tick_r(sched);
+        btimeslice_exec_r(sched);
+        most = burst > most ? burst : most;
+    }
+    for (size_t i = 0; i != 150; ++i)
+    {
+        if (hits[i] != 200 / btimeslice_slice(task + i))
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, hits[i]);
+            status = 1;
+        }
+    }
+    if (most > 100 / 10 + (50 + 19) / 20)
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, most);
+        status = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t once = 0;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    btimeslice_cron(btimeslice + 0, btimeslice1_exec, ref, slice[0]);
+    btimeslice_cron(btimeslice + 1, btimeslice2_exec, ref, slice[1]);
+    btimeslice_cron(btimeslice + 2, btimeslice3_exec, ref, slice[2]);
+    btimeslice_cron(btimeslice + 3, btimeslice4_exec, ref, slice[3]);
+    btimeslice_cron(btimeslice + 4, btimeslice5_exec, ref, slice[4]);
+    btimeslice_once(btimeslice + 5, btimeslice6_exec, &once, 100);
+    for (size_t i = 0; i != 6; ++i)
+    {
+        btimeslice_join(btimeslice + i);
+    }
+    /* the crowd shares the buckets of four periods */
+    for (size_t i = 0; i != 100; ++i)
+    {
+        btimeslice_cron(crowd + i, btimeslice7_exec, count + i, period[i % 4]);
+        btimeslice_join(crowd + i);
+    }
+    if (btimeslice_count() != 106)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        btimeslice_tick();
+        btimeslice_exec();
+        if (n == step / 2)
+        {
+            /* the task keeps its next release, then follows the bucket of the new slice */
+            size_t timer = btimeslice_timer(crowd + 1);
+            btimeslice_set_slice(crowd + 1, 100);
+            if (btimeslice_timer(crowd + 1) != timer)
+            {
+                printf("failure in %s %i\n", __FILE__, __LINE__);
+                status = 1;
+            }
+        }
+    }
+
+    for (size_t i = 1; i != 5; ++i)
+    {
+        if (ref[i] != step / slice[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, ref[i]);
+            status = 1;
+        }
+    }
+    for (size_t i = 2; i != 100; ++i)
+    {
+        if (count[i] != step / period[i % 4])
+        {
+            printf("failure in %s %i crowd%zu %zu\n", __FILE__, __LINE__, i, count[i]);
+            status = 1;
+        }
+    }
+    if (step >= 2000 && (count[1] < step / 2 / 10 || count[1] > step / 2 / 10 + step / 2 / 100 + 1))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (once != (step >= 100) || btimeslice_exist(btimeslice + 5) != (step < 100))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (btimeslice_timer(btimeslice + 4) != slice[4] - step % slice[4])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    btimeslice_drop(btimeslice + 4);
+    if (btimeslice_exist(btimeslice + 4))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (size_t i = 0; i != 100; ++i)
+    {
+        btimeslice_drop(crowd + i);
+    }
+    if (btimeslice_count() !=
+        3U + static_cast<size_t>(btimeslice_exist(btimeslice + 0)) + static_cast<size_t>(btimeslice_exist(btimeslice + 5)))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    btimeslice_pool();
+    btimeslice_stagger();
+
+    printf("task1 %zu\n", ref[0]);
+    printf("task2 %zu\n", ref[1]);
+    printf("task3 %zu\n", ref[2]);
+    printf("task4 %zu\n", ref[3]);
+    printf("task5 %zu\n", ref[4]);
+
+    return status;
+}
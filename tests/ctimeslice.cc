@@ -0,0 +1,140 @@
+/*!
+ @file ctimeslice.cc
+ @brief Tesing cooperative scheduler timeslice with compact tasks in an array.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "ctimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[5] = {0};
+static ctimeslice_sched_s sched[1];
+static ctimeslice_s ctimeslice[8];
+static ctimeslice_call_s call[8];
+static const size_t slice[5] = {10, 63, 64, 4097, 60000};
+
+static void ctimeslice1_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 0;
+    if (++*p % 2 == 0)
+    {
+        ctimeslice_drop_r(sched, 0);
+        ctimeslice_drop_r(sched, 0);
+    }
+}
+
+static void ctimeslice2_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 1;
+    if (++*p % 2 == 0)
+    {
+        ctimeslice_join_r(sched, 0);
+        ctimeslice_join_r(sched, 0);
+    }
+}
+
+static void ctimeslice3_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 2);
+}
+
+static void ctimeslice4_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 3);
+}
+
+static void ctimeslice5_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 4);
+}
+
+static void ctimeslice6_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+    if (ctimeslice_self_r(sched) != 5)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t once = 0;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    ctimeslice_sched_init(sched, ctimeslice, call, 8);
+    ctimeslice_cron_r(sched, 0, ctimeslice1_exec, ref, slice[0]);
+    ctimeslice_cron_r(sched, 1, ctimeslice2_exec, ref, slice[1]);
+    ctimeslice_cron_r(sched, 2, ctimeslice3_exec, ref, slice[2]);
+    ctimeslice_cron_r(sched, 3, ctimeslice4_exec, ref, slice[3]);
+    ctimeslice_cron_r(sched, 4, ctimeslice5_exec, ref, slice[4]);
+    ctimeslice_once_r(sched, 5, ctimeslice6_exec, &once, 100);
+    for (size_t i = 0; i != 6; ++i)
+    {
+        ctimeslice_join_r(sched, i);
+    }
+    if (ctimeslice_count_r(sched) != 6)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        ctimeslice_tick_r(sched);
+        ctimeslice_exec_r(sched);
+    }
+
+    for (size_t i = 1; i != 5; ++i)
+    {
+        if (ref[i] != step / slice[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, ref[i]);
+            status = 1;
+        }
+    }
+    if (once != (step >= 100) || ctimeslice_exist_r(sched, 5) != (step < 100))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (ctimeslice_timer_r(sched, 4) != slice[4] - step % slice[4])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    ctimeslice_drop_r(sched, 4);
+    if (ctimeslice_exist_r(sched, 4))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (ctimeslice_count_r(sched) !=
+        3U + static_cast<size_t>(ctimeslice_exist_r(sched, 0)) + static_cast<size_t>(ctimeslice_exist_r(sched, 5)))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (sizeof(ctimeslice_s) * 5 > 64)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("task1 %zu\n", ref[0]);
+    printf("task2 %zu\n", ref[1]);
+    printf("task3 %zu\n", ref[2]);
+    printf("task4 %zu\n", ref[3]);
+    printf("task5 %zu\n", ref[4]);
+
+    return status;
+}
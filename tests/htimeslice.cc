@@ -0,0 +1,115 @@
+/*!
+ @file htimeslice.cc
+ @brief Tesing cooperative scheduler timeslice based on deadline heap.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "htimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[5] = {0};
+static htimeslice_s htimeslice[5];
+static const size_t slice[5] = {10, 63, 64, 4097, 300000};
+
+static void htimeslice1_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 0;
+    if (++*p % 2 == 0)
+    {
+        htimeslice_drop(htimeslice + 0);
+        htimeslice_drop(htimeslice + 0);
+    }
+}
+
+static void htimeslice2_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 1;
+    if (++*p % 2 == 0)
+    {
+        htimeslice_join(htimeslice + 0);
+        htimeslice_join(htimeslice + 0);
+    }
+}
+
+static void htimeslice3_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 2);
+}
+
+static void htimeslice4_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 3);
+}
+
+static void htimeslice5_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 4);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    htimeslice_cron(htimeslice + 0, htimeslice1_exec, ref, slice[0]);
+    htimeslice_cron(htimeslice + 1, htimeslice2_exec, ref, slice[1]);
+    htimeslice_cron(htimeslice + 2, htimeslice3_exec, ref, slice[2]);
+    htimeslice_cron(htimeslice + 3, htimeslice4_exec, ref, slice[3]);
+    htimeslice_cron(htimeslice + 4, htimeslice5_exec, ref, slice[4]);
+    htimeslice_join(htimeslice + 0);
+    htimeslice_join(htimeslice + 1);
+    htimeslice_join(htimeslice + 2);
+    htimeslice_join(htimeslice + 3);
+    htimeslice_join(htimeslice + 4);
+    if (htimeslice_count() != 5)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        htimeslice_tick();
+        htimeslice_exec();
+    }
+
+    for (size_t i = 1; i != 5; ++i)
+    {
+        if (ref[i] != step / slice[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, ref[i]);
+            status = 1;
+        }
+    }
+    if (htimeslice_timer(htimeslice + 4) != slice[4] - step % slice[4])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    htimeslice_drop(htimeslice + 4);
+    if (htimeslice_exist(htimeslice + 4))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (htimeslice_count() != (htimeslice_exist(htimeslice + 0) ? 4U : 3U))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("task1 %zu\n", ref[0]);
+    printf("task2 %zu\n", ref[1]);
+    printf("task3 %zu\n", ref[2]);
+    printf("task4 %zu\n", ref[3]);
+    printf("task5 %zu\n", ref[4]);
+
+    return status;
+}
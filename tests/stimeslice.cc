@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <thread>
 
+static int status = 0;
 static size_t step = 0;
 static size_t ref[5] = {0};
 static stimeslice_s stimeslice[5];
@@ -50,6 +51,44 @@ static void stimeslice5_exec(void *arg)
     ++*(static_cast<size_t *>(arg) + 4);
 }
 
+static stimeslice_sched_s *stimeslice_self_sched;
+
+static void stimeslice_self_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg);
+    /* a null task refers to this task, though it is not on the default instance */
+    if (stimeslice_slice(0) == 7 && stimeslice_exist(0))
+    {
+        ++*p;
+    }
+    stimeslice_drop_r(stimeslice_self_sched, 0);
+}
+
+static void stimeslice_self_test(void)
+{
+    static stimeslice_s task[2];
+    stimeslice_sched_s sched[1];
+    size_t count = 0;
+    stimeslice_sched_init(sched);
+    stimeslice_self_sched = sched;
+    stimeslice_cron(task + 0, stimeslice_self_exec, &count, 7);
+    stimeslice_cron(task + 1, stimeslice3_exec, ref, 1);
+    stimeslice_join_r(sched, task + 0);
+    stimeslice_join_r(sched, task + 1);
+    for (size_t n = 0; n != 7; ++n)
+    {
+        stimeslice_tick_r(sched);
+        stimeslice_exec_r(sched);
+    }
+    if (count != 1 || stimeslice_exist(task + 0) || !stimeslice_exist(task + 1) || stimeslice_count_r(sched) != 1)
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, count);
+        status = 1;
+    }
+    stimeslice_drop_r(sched, task + 1);
+    ref[2] = 0;
+}
+
 static void stimeslice_show(void *arg)
 {
     printf("\r\n");
@@ -75,7 +114,7 @@ static void stimeslice_show(void *arg)
         stimeslice_show(ref);
     }
     printf("\n\n\n\n\n\n");
-    exit(0);
+    exit(status);
 }
 
 [[noreturn]] static void stimeslice_exec_thread(void)
@@ -95,21 +134,25 @@ static void stimeslice_show(void *arg)
     if (stimeslice_exist(stimeslice + 1))
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
 
     stimeslice_drop(stimeslice + 4);
     if (stimeslice_count() != 3)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     if (stimeslice_exist(stimeslice + 2) == 0)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     stimeslice_join(stimeslice + 1);
     if (stimeslice_exist(stimeslice + 1) == 0)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     stimeslice_join(stimeslice + 4);
 
@@ -125,6 +168,7 @@ int main(int argc, char *argv[])
     {
         step = static_cast<size_t>(atoi(argv[1]));
     }
+    stimeslice_self_test();
 
     std::thread thread_1(stimeslice_exec_thread);
     std::thread thread_2(stimeslice_tick_thread);
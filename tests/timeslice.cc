@@ -10,7 +10,11 @@
 #include <cstdlib>
 #include <cstdio>
 #include <thread>
+#if defined(TIMESLICE_ATOMIC)
+#include <atomic>
+#endif /* TIMESLICE_ATOMIC */
 
+static int status = 0;
 static size_t step = 0;
 static size_t ref[5] = {0};
 static timeslice_s timeslice[5];
@@ -50,6 +54,215 @@ static void timeslice5_exec(void *arg)
     ++*(static_cast<size_t *>(arg) + 4);
 }
 
+static void timeslice_count_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static void timeslice_ready_test(void)
+{
+    static timeslice_s task[1000];
+    timeslice_sched_s sched[1];
+    size_t count = 0;
+    timeslice_sched_init(sched);
+    for (size_t i = 0; i != 1000; ++i)
+    {
+        timeslice_cron(task + i, timeslice_count_exec, &count, 1);
+        timeslice_join_r(sched, task + i);
+    }
+    /* every task that is due on a tick is executed, however many there are */
+    for (size_t n = 0; n != 100; ++n)
+    {
+        timeslice_tick_r(sched);
+        timeslice_exec_r(sched);
+    }
+    if (count != 100 * 1000)
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, count);
+        status = 1;
+    }
+}
+
+static void timeslice_drop_test(void)
+{
+    static timeslice_s task[2];
+    timeslice_sched_s sched[1];
+    size_t count = 0, hits = 0;
+    timeslice_sched_init(sched);
+    timeslice_cron(task + 0, timeslice_count_exec, &count, 1);
+    timeslice_cron(task + 1, timeslice_count_exec, &count, 1);
+    timeslice_join_r(sched, task + 0);
+    timeslice_join_r(sched, task + 1);
+    timeslice_tick_r(sched);
+    /* a dropped task is let go at once, so it may be initialized again before the next tick */
+    timeslice_drop_r(sched, task + 0);
+    if (timeslice_held(task + 0))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    timeslice_once(task + 0, timeslice_count_exec, &hits, 1);
+    timeslice_join_r(sched, task + 0);
+    timeslice_tick_r(sched);
+    timeslice_exec_r(sched);
+    if (count != 1 || hits != 1 || timeslice_held(task + 0) || timeslice_count_r(sched) != 1)
+    {
+        printf("failure in %s %i %zu %zu\n", __FILE__, __LINE__, count, hits);
+        status = 1;
+    }
+    /* and so may a due cron task that joins again */
+    timeslice_tick_r(sched);
+    timeslice_drop_r(sched, task + 1);
+    timeslice_cron(task + 1, timeslice_count_exec, &count, 1);
+    timeslice_join_r(sched, task + 1);
+    for (size_t n = 0; n != 10; ++n)
+    {
+        timeslice_tick_r(sched);
+        timeslice_exec_r(sched);
+    }
+    timeslice_drop_r(sched, task + 1);
+    if (count != 11 || timeslice_held(task + 1) || timeslice_count_r(sched) != 0)
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, count);
+        status = 1;
+    }
+}
+
+static void timeslice_pull_test(void)
+{
+    static timeslice_s task[3];
+    timeslice_sched_s sched[1];
+    timeslice_s *ctx;
+    size_t count = 0, pulls = 0;
+    timeslice_sched_init(sched);
+    for (size_t i = 0; i != 3; ++i)
+    {
+        timeslice_cron(task + i, timeslice_count_exec, &count, 1);
+        timeslice_join_r(sched, task + i);
+    }
+    timeslice_tick_r(sched);
+    /* a drop takes out the dropped task only, and the other due tasks are still pulled */
+    timeslice_drop_r(sched, task + 1);
+    while ((ctx = timeslice_pull_r(sched)) != 0)
+    {
+        timeslice_call_r(sched, ctx);
+        ++pulls;
+    }
+    if (pulls != 2 || count != 2 || timeslice_held(task + 1))
+    {
+        printf("failure in %s %i %zu %zu\n", __FILE__, __LINE__, pulls, count);
+        status = 1;
+    }
+}
+
+static timeslice_sched_s *timeslice_self_sched;
+
+static void timeslice_self_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg);
+    /* a null task refers to this task, though it is not on the default instance */
+    if (timeslice_slice(0) == 7 && timeslice_held(0) && timeslice_exist(0))
+    {
+        ++*p;
+    }
+    timeslice_drop_r(timeslice_self_sched, 0);
+}
+
+static void timeslice_self_test(void)
+{
+    static timeslice_s task[2];
+    timeslice_sched_s sched[1];
+    size_t count = 0;
+    timeslice_sched_init(sched);
+    timeslice_self_sched = sched;
+    timeslice_cron(task + 0, timeslice_self_exec, &count, 7);
+    timeslice_cron(task + 1, timeslice_count_exec, &count, 1);
+    timeslice_join_r(sched, task + 0);
+    timeslice_join_r(sched, task + 1);
+    for (size_t n = 0; n != 7; ++n)
+    {
+        timeslice_tick_r(sched);
+        timeslice_exec_r(sched);
+    }
+    if (count != 8 || timeslice_exist(task + 0) || !timeslice_exist(task + 1) || timeslice_count_r(sched) != 1)
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, count);
+        status = 1;
+    }
+    timeslice_drop_r(sched, task + 1);
+}
+
+#if defined(TIMESLICE_ATOMIC)
+static void timeslice_held_exec(void *arg)
+{
+    ++*static_cast<std::atomic<size_t> *>(arg);
+}
+
+static void timeslice_held_test(void)
+{
+    static timeslice_s task[64];
+    static std::atomic<size_t> count(0);
+    std::atomic<bool> stop(false);
+    timeslice_sched_s sched[1];
+    timeslice_sched_init(sched);
+    for (size_t i = 0; i != 64; ++i)
+    {
+        timeslice_cron(task + i, timeslice_held_exec, &count, 1);
+        timeslice_join_r(sched, task + i);
+    }
+    std::thread tick([&] {
+        while (!stop)
+        {
+            timeslice_tick_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    std::thread exec([&] {
+        while (!stop)
+        {
+            timeslice_exec_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    for (size_t wait = 0; count == 0; ++wait)
+    {
+        if (wait == 10000000)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+            break;
+        }
+        std::this_thread::yield();
+    }
+    /* a task dropped on another thread is let go by the tick and the exec, then it joins again */
+    for (size_t n = 0; n != 1000 && !status; ++n)
+    {
+        timeslice_s *ctx = task + n % 64;
+        timeslice_drop_r(sched, ctx);
+        for (size_t wait = 0; timeslice_held(ctx); ++wait)
+        {
+            if (wait == 10000000)
+            {
+                printf("failure in %s %i %zu\n", __FILE__, __LINE__, n);
+                status = 1;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        timeslice_cron(ctx, timeslice_held_exec, &count, 1);
+        timeslice_join_r(sched, ctx);
+    }
+    stop = true;
+    tick.join();
+    exec.join();
+    if (timeslice_count_r(sched) != 64 || count == 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+#endif /* TIMESLICE_ATOMIC */
+
 static void timeslice_show(void *arg)
 {
     printf("\r\n");
@@ -61,23 +274,7 @@ static void timeslice_show(void *arg)
     printf("\r\033[6A");
 }
 
-[[noreturn]] static void timeslice_tick_thread(void)
-{
-    for (size_t n = 0; n != step; ++n)
-    {
-        timeslice_tick();
-        if (n % 1000)
-        {
-            continue;
-        }
-        printf("\rcount %zu tick %zu", timeslice_count(), n);
-        timeslice_show(ref);
-    }
-    printf("\n\n\n\n\n\n");
-    exit(0);
-}
-
-[[noreturn]] static void timeslice_exec_thread(void)
+static void timeslice_exec_join(void)
 {
     timeslice_cron(timeslice + 0, timeslice1_exec, ref, 10);
     timeslice_cron(timeslice + 1, timeslice2_exec, ref, 20);
@@ -94,29 +291,55 @@ static void timeslice_show(void *arg)
     if (timeslice_exist(timeslice + 1))
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
 
     timeslice_drop(timeslice + 4);
     if (timeslice_count() != 3)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     if (timeslice_exist(timeslice + 2) == 0)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     timeslice_join(timeslice + 1);
     if (timeslice_exist(timeslice + 1) == 0)
     {
         printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
     }
     timeslice_join(timeslice + 4);
+}
 
+#if defined(TIMESLICE_ATOMIC)
+[[noreturn]] static void timeslice_tick_thread(void)
+{
+    for (size_t n = 0; n != step; ++n)
+    {
+        timeslice_tick();
+        if (n % 1000)
+        {
+            continue;
+        }
+        printf("\rcount %zu tick %zu", timeslice_count(), n);
+        timeslice_show(ref);
+    }
+    printf("\n\n\n\n\n\n");
+    exit(status);
+}
+
+[[noreturn]] static void timeslice_exec_thread(void)
+{
+    timeslice_exec_join();
     while (true)
     {
-        timeslice_exec();
+        timeslice_exec_wait();
     }
 }
+#endif /* TIMESLICE_ATOMIC */
 
 int main(int argc, char *argv[])
 {
@@ -124,12 +347,31 @@ int main(int argc, char *argv[])
     {
         step = static_cast<size_t>(atoi(argv[1]));
     }
+    timeslice_ready_test();
+    timeslice_drop_test();
+    timeslice_pull_test();
+    timeslice_self_test();
+#if defined(TIMESLICE_ATOMIC)
+    timeslice_held_test();
+#endif /* TIMESLICE_ATOMIC */
 
+#if defined(TIMESLICE_ATOMIC)
     std::thread thread_1(timeslice_exec_thread);
     std::thread thread_2(timeslice_tick_thread);
 
     thread_1.join();
     thread_2.join();
+#else /* !TIMESLICE_ATOMIC */
+    /* without atomics the tick and the exec share a single context */
+    timeslice_exec_join();
+    for (size_t n = 0; n != step; ++n)
+    {
+        timeslice_tick();
+        timeslice_exec();
+    }
+    timeslice_show(ref);
+    printf("\n\n\n\n\n\n");
+#endif /* TIMESLICE_ATOMIC */
 
-    return 0;
+    return status;
 }
@@ -0,0 +1,274 @@
+/*!
+ @file timeslice_coro.cc
+ @brief Tesing coroutine tasks of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#define TIMESLICE_CORO_COUNT 4
+#if defined(__GNUC__) && !defined(__clang__)
+/* the coroutine tasks are returned by value, and the frames are laid out by the compiler */
+#pragma GCC diagnostic ignored "-Waggregate-return"
+#pragma GCC diagnostic ignored "-Wswitch-default"
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ */
+#include "timeslice_coro.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+static size_t step = 0;
+static size_t heap = 0;
+static int status = 0;
+
+void *operator new(std::size_t size)
+{
+    ++heap;
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+static ts::task sleeper(size_t *count, size_t ticks, size_t times)
+{
+    for (size_t n = 0; n != times; ++n)
+    {
+        ++*count;
+        co_await ts::sleep(ticks);
+    }
+}
+
+static ts::task ticker(size_t *count)
+{
+    for (;;)
+    {
+        ++*count;
+        co_await ts::next_tick();
+    }
+}
+
+#if defined(TIMESLICE_ATOMIC)
+/* the coroutine writes to its own frame, which a destruction under it would corrupt */
+static ts::task spinner(std::atomic<size_t> *total)
+{
+    for (size_t runs = 0;; ++runs)
+    {
+        total->fetch_add(runs ? 1 : 0, std::memory_order_relaxed);
+        co_await ts::next_tick();
+    }
+}
+
+/* the tasks are destroyed on a third thread while the tick and the exec resume them */
+static void cross_test(void)
+{
+    timeslice_sched_s sched[1];
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+    timeslice_sched_init(sched);
+    std::thread tick([&] {
+        while (!stop)
+        {
+            timeslice_tick_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    std::thread exec([&] {
+        while (!stop)
+        {
+            timeslice_exec_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    for (size_t n = 0; n != 200; ++n)
+    {
+        ts::task task[4] = {spinner(&total), spinner(&total), spinner(&total), spinner(&total)};
+        for (size_t i = 0; i != 4; ++i)
+        {
+            task[i].join(sched);
+        }
+        for (size_t wait = 0; n == 0 && total == 0; ++wait)
+        {
+            if (wait == 10000000)
+            {
+                printf("failure in %s %i\n", __FILE__, __LINE__);
+                status = 1;
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    stop = true;
+    tick.join();
+    exec.join();
+    if (timeslice_count_r(sched) != 0 || ts::frame_pool::count() != 0 || total == 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+#endif /* TIMESLICE_ATOMIC */
+
+int main(int argc, char *argv[])
+{
+    size_t count[4] = {0};
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    {
+        ts::task task[4] = {
+            sleeper(count + 0, 3, step + 1),
+            sleeper(count + 1, 10, 5),
+            ticker(count + 2),
+            sleeper(count + 3, 0, 2),
+        };
+        if (!task[0] || !task[1] || !task[2] || !task[3] || ts::frame_pool::count() != 4)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+            return status;
+        }
+        /* the pool is used up, so the coroutine comes without a frame */
+        if (sleeper(count, 1, 1))
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+
+        /* the first join resumes the coroutine without waiting for a tick */
+        for (size_t i = 0; i != 4; ++i)
+        {
+            task[i].join();
+        }
+        timeslice_exec();
+        for (size_t i = 0; i != 4; ++i)
+        {
+            if (count[i] != 1)
+            {
+                printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, count[i]);
+                status = 1;
+            }
+        }
+
+        /* the suspensions and the resumptions do not allocate */
+        heap = 0;
+        for (size_t n = 1; n <= step; ++n)
+        {
+            timeslice_tick();
+            timeslice_exec();
+        }
+        if (heap != 0)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        if (count[0] != step / 3 + 1 || count[1] != (step < 40 ? step / 10 + 1 : 5) || count[2] != step + 1 ||
+            count[3] != (step ? 2 : 1))
+        {
+            printf("failure in %s %i %zu %zu %zu %zu\n", __FILE__, __LINE__, count[0], count[1], count[2], count[3]);
+            status = 1;
+        }
+        /* the coroutine that returned has dropped itself */
+        if (step >= 50 && (!task[1].done() || timeslice_exist(task[1].get()) || !task[3].done()))
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+
+        /* a dropped coroutine keeps its place */
+        task[2].drop();
+        timeslice_tick();
+        timeslice_exec();
+        if (count[2] != step + 1)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        task[2].join();
+        timeslice_tick();
+        timeslice_exec();
+        if (count[2] != step + 2)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        for (size_t i = 0; i != 4; ++i)
+        {
+            task[i].drop();
+        }
+        timeslice_tick();
+    }
+
+    /* the frames are given back and reused */
+    if (ts::frame_pool::count() != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    heap = 0;
+    {
+        ts::task task = sleeper(count, 1, 1);
+        ts::task move = static_cast<ts::task &&>(task);
+        if (task || !move || ts::frame_pool::count() != 1)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+    }
+    if (heap != 0 || ts::frame_pool::count() != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* the frame of a finished task is reused at once, before the tick lets go of its task */
+    {
+        size_t runs = 0;
+        {
+            ts::task task = sleeper(&runs, 1, 2);
+            task.join();
+            for (size_t n = 0; !task.done() && n != 10; ++n)
+            {
+                timeslice_tick();
+                timeslice_exec();
+            }
+            if (!task.done() || runs != 2)
+            {
+                printf("failure in %s %i\n", __FILE__, __LINE__);
+                status = 1;
+            }
+        }
+        ts::task task = sleeper(&runs, 1, 3);
+        task.join();
+        for (size_t n = 0; n != 10; ++n)
+        {
+            timeslice_tick();
+            timeslice_exec();
+        }
+        if (!task.done() || runs != 5 || timeslice_count() != 0)
+        {
+            printf("failure in %s %i %zu\n", __FILE__, __LINE__, runs);
+            status = 1;
+        }
+    }
+
+#if defined(TIMESLICE_ATOMIC)
+    cross_test();
+#endif /* TIMESLICE_ATOMIC */
+
+    printf("coro %zu\n", count[0]);
+
+    return status;
+}
@@ -0,0 +1,246 @@
+/*!
+ @file timeslice_cxx.cc
+ @brief Tesing C++ wrapper of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.hpp"
+
+#include <optional>
+#include <vector>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+static size_t step = 0;
+static size_t heap = 0;
+static size_t calls = 0;
+static int status = 0;
+
+void *operator new(std::size_t size)
+{
+    ++heap;
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+class counter
+{
+public:
+    size_t runs = 0;
+    void tick() { ++runs; }
+    void peek() const noexcept { ++calls; }
+};
+
+static void count(void)
+{
+    ++calls;
+}
+
+#if defined(TIMESLICE_ATOMIC)
+/* the callable writes to its own storage, which a destruction under it would corrupt */
+struct cross
+{
+    size_t runs;
+    std::atomic<size_t> *total;
+    void operator()()
+    {
+        ++runs;
+        total->fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+/* the wrappers are destroyed and moved on a third thread while the tick and the exec walk them */
+static void cross_test(void)
+{
+    timeslice_sched_s sched[1];
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> total{0};
+    timeslice_sched_init(sched);
+    std::thread tick([&] {
+        while (!stop)
+        {
+            timeslice_tick_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    std::thread exec([&] {
+        while (!stop)
+        {
+            timeslice_exec_r(sched);
+            std::this_thread::yield();
+        }
+    });
+    for (size_t n = 0; n != 200; ++n)
+    {
+        std::vector<ts::cron<cross>> tasks;
+        for (size_t i = 0; i != 8; ++i)
+        {
+            tasks.emplace_back(1, cross{0, &total});
+            tasks.back().join(sched);
+        }
+        for (size_t wait = 0; n == 0 && total == 0; ++wait)
+        {
+            if (wait == 10000000)
+            {
+                printf("failure in %s %i\n", __FILE__, __LINE__);
+                status = 1;
+                break;
+            }
+            std::this_thread::yield();
+        }
+        tasks.erase(tasks.begin());
+    }
+    stop = true;
+    tick.join();
+    exec.join();
+    if (timeslice_count_r(sched) != 0 || total == 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+#endif /* TIMESLICE_ATOMIC */
+
+int main(int argc, char *argv[])
+{
+    size_t runs = 0;
+    counter object;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    heap = 0;
+    {
+        ts::cron lambda(2, [&runs] { ++runs; });
+        ts::cron member(5, ts::bind<&counter::tick>(&object));
+        ts::cron constant(10, ts::bind<&counter::peek>(&object));
+        ts::cron function(10, count);
+        /* the callable is stored inline, with no room beyond its own size */
+        if (sizeof(lambda) > sizeof(timeslice_s) + sizeof(void *) * 2)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        lambda.join();
+        member.join();
+        constant.join();
+        function.join();
+        if (timeslice_count() != 4)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        for (size_t n = 0; n != step; ++n)
+        {
+            timeslice_tick();
+            timeslice_exec();
+        }
+        if (runs != step / 2 || object.runs != step / 5 || calls != step / 10 * 2)
+        {
+            printf("failure in %s %i %zu %zu %zu\n", __FILE__, __LINE__, runs, object.runs, calls);
+            status = 1;
+        }
+        lambda.drop();
+        member.drop();
+        constant.drop();
+        function.drop();
+        timeslice_tick();
+    }
+    if (heap != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* a joined task that is moved or destroyed lets go of its storage at once */
+    using task_t = ts::cron<ts::bind<&counter::tick>>;
+    static std::optional<task_t> task[2];
+    object.runs = 0;
+    task[0].emplace(1, ts::bind<&counter::tick>(&object));
+    task[0]->join();
+    timeslice_tick();
+    timeslice_exec();
+    task[1].emplace(static_cast<task_t &&>(*task[0]));
+    if (task[0]->exist() || !task[1]->exist() || timeslice_count() != 1)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    timeslice_tick();
+    timeslice_exec();
+    if (object.runs != 2)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    task[0].reset();
+    task[1].reset();
+    timeslice_tick();
+    timeslice_exec();
+    if (object.runs != 2 || timeslice_count() != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    {
+        ts::cron scoped(1, [&runs] { ++runs; });
+        scoped.join();
+        timeslice_tick();
+        timeslice_exec();
+    }
+    timeslice_tick();
+    timeslice_exec();
+    if (timeslice_count() != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    {
+        using each_t = ts::cron<ts::bind<&counter::tick>>;
+        std::vector<each_t> tasks;
+        object.runs = 0;
+        for (size_t i = 0; i != 16; ++i)
+        {
+            tasks.emplace_back(1, ts::bind<&counter::tick>(&object));
+            tasks.back().join();
+            timeslice_tick();
+            timeslice_exec();
+        }
+        if (object.runs != 16 * 17 / 2 || timeslice_count() != 16)
+        {
+            printf("failure in %s %i %zu\n", __FILE__, __LINE__, object.runs);
+            status = 1;
+        }
+    }
+    timeslice_tick();
+    timeslice_exec();
+    if (timeslice_count() != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+#if defined(TIMESLICE_ATOMIC)
+    cross_test();
+#endif /* TIMESLICE_ATOMIC */
+
+    printf("cxx %zu\n", runs);
+
+    return status;
+}
@@ -0,0 +1,108 @@
+/*!
+ @file timeslice_hist.cc
+ @brief Tesing latency histogram of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+#include "stimeslice.h"
+#include "timeslice_hist.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static timeslice_hist_s hist[1];
+
+/* the reported value is not below the exact one and within the relative error */
+static int check(uint64_t value, uint64_t exact)
+{
+    return value >= exact && value - exact <= exact >> TIMESLICE_HIST_BITS;
+}
+
+#if defined(TIMESLICE_HIST)
+static timeslice_s timeslice[1];
+static stimeslice_s stimeslice[1];
+static void exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+#endif /* TIMESLICE_HIST */
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_hist_reset(hist);
+    if (timeslice_hist_quantile(hist, 0.5) != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (uint64_t i = 1; i <= 100000; ++i)
+    {
+        timeslice_hist_add(hist, i * 1000);
+    }
+    if (!check(timeslice_hist_quantile(hist, 0.5), 50000000) ||
+        !check(timeslice_hist_quantile(hist, 0.99), 99000000) ||
+        !check(timeslice_hist_quantile(hist, 0.999), 99900000))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (timeslice_hist_max(hist) != 100000000 || timeslice_hist_quantile(hist, 1) != 100000000)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (uint64_t i = 0; i != 64; ++i)
+    {
+        timeslice_hist_reset(hist);
+        timeslice_hist_add(hist, i);
+        if (timeslice_hist_quantile(hist, 0.5) != i)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+    }
+    timeslice_hist_add(hist, ~static_cast<uint64_t>(0));
+    if (timeslice_hist_total(hist) != 2 || timeslice_hist_quantile(hist, 1) != ~static_cast<uint64_t>(0))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+#if defined(TIMESLICE_HIST)
+    size_t ref = 0;
+    timeslice_hist_reset(hist);
+    timeslice_hist_attach(hist);
+    stimeslice_hist_attach(hist);
+    timeslice_cron(timeslice, exec, &ref, 1);
+    stimeslice_cron(stimeslice, exec, &ref, 1);
+    timeslice_join(timeslice);
+    stimeslice_join(stimeslice);
+    for (size_t n = 1; n <= step; ++n)
+    {
+        timeslice_tick();
+        timeslice_exec();
+        stimeslice_tick();
+        stimeslice_exec();
+    }
+    if (timeslice_hist_total(hist) != 2 * step || ref != 2 * step)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    printf("p50 %llu p99 %llu p99.9 %llu max %llu\n",
+           static_cast<unsigned long long>(timeslice_hist_quantile(hist, 0.5)),
+           static_cast<unsigned long long>(timeslice_hist_quantile(hist, 0.99)),
+           static_cast<unsigned long long>(timeslice_hist_quantile(hist, 0.999)),
+           static_cast<unsigned long long>(timeslice_hist_max(hist)));
+#endif /* TIMESLICE_HIST */
+
+    return status;
+}
@@ -0,0 +1,177 @@
+/*!
+ @file timeslice_io.cc
+ @brief Tesing io tasks of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+#if defined(__linux__)
+#include <unistd.h>
+#if defined(TIMESLICE_ATOMIC)
+#define IO_THREAD
+#include <atomic>
+#include <thread>
+#endif /* TIMESLICE_ATOMIC */
+
+static size_t step = 0;
+static int status = 0;
+static int fds[2];
+static timeslice_s timeslice[2];
+static unsigned int seen = 0;
+
+#if defined(IO_THREAD)
+static std::atomic<size_t> count(0);
+#else /* !IO_THREAD */
+static size_t count = 0;
+#endif /* IO_THREAD */
+
+static void exec(void *arg)
+{
+    char c;
+    seen = timeslice_revents(0);
+    if (seen & TIMESLICE_POLLIN)
+    {
+        ssize_t size = read(*static_cast<int *>(arg), &c, 1);
+        (void)size;
+    }
+    ++count;
+}
+
+static void feed(void)
+{
+    char c = 0;
+    ssize_t size = write(fds[1], &c, 1);
+    (void)size;
+}
+
+#if defined(IO_THREAD)
+/* the writes wake the exec from the file descriptor, the ticks wake it from the kick */
+static void writer(void)
+{
+    for (size_t n = 0; n != step; ++n)
+    {
+        while (count != n)
+        {
+            std::this_thread::yield();
+        }
+        if (n % 2)
+        {
+            timeslice_set_timer(timeslice + 0, 1);
+            timeslice_tick();
+        }
+        else
+        {
+            feed();
+        }
+    }
+}
+#endif /* IO_THREAD */
+#endif /* __linux__ */
+
+int main(int argc, char *argv[])
+{
+#if defined(__linux__)
+    size_t runs = 0;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+    if (pipe(fds) < 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+        return status;
+    }
+
+    timeslice_io(timeslice + 0, exec, fds + 0, fds[0], TIMESLICE_POLLIN, 5);
+    timeslice_join(timeslice + 0);
+    timeslice_tick();
+
+    /* the ready file descriptor makes the task due at once */
+    feed();
+    timeslice_exec_wait();
+    if (count != 1 || seen != TIMESLICE_POLLIN || timeslice_revents(timeslice + 0) != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* the timeout releases the task without events */
+    for (size_t n = 0; n != 5; ++n)
+    {
+        timeslice_tick();
+    }
+    timeslice_exec_wait();
+    if (count != 2 || seen != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* the ready file descriptor restarts the timeout */
+    timeslice_tick();
+    timeslice_tick();
+    feed();
+    timeslice_exec_wait();
+    if (count != 3 || seen != TIMESLICE_POLLIN || timeslice_timer(timeslice + 0) != 5)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* a dropped task is not watched */
+    timeslice_cron(timeslice + 1, [](void *arg) { ++*static_cast<size_t *>(arg); }, &runs, 0);
+    timeslice_join(timeslice + 1);
+    timeslice_drop(timeslice + 0);
+    timeslice_tick();
+    feed();
+    timeslice_notify(timeslice + 1);
+    timeslice_exec_wait();
+    if (count != 3 || runs != 1)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    timeslice_join(timeslice + 0);
+    timeslice_tick();
+    timeslice_exec_wait();
+    if (count != 4 || seen != TIMESLICE_POLLIN)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    count = 0;
+#if defined(IO_THREAD)
+    std::thread thread(writer);
+    while (count != step)
+    {
+        timeslice_exec_wait();
+    }
+    thread.join();
+#else /* !IO_THREAD */
+    for (size_t n = 0; n != step; ++n)
+    {
+        feed();
+        timeslice_exec_wait();
+    }
+#endif /* IO_THREAD */
+    if (count != step)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("io %zu\n", static_cast<size_t>(count));
+    close(fds[0]);
+    close(fds[1]);
+#else /* !__linux__ */
+    (void)argc;
+    (void)argv;
+#endif /* __linux__ */
+
+    return status;
+}
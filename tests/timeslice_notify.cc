@@ -0,0 +1,134 @@
+/*!
+ @file timeslice_notify.cc
+ @brief Tesing event-triggered tasks of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+
+#include <csignal>
+#include <cstdlib>
+#include <cstdio>
+#if defined(TIMESLICE_ATOMIC) && defined(SIGUSR1)
+#define NOTIFY_THREAD
+#include <atomic>
+#include <thread>
+#endif /* TIMESLICE_ATOMIC && SIGUSR1 */
+
+static size_t step = 0;
+static int status = 0;
+static timeslice_s timeslice[2];
+
+#if defined(NOTIFY_THREAD)
+static std::atomic<size_t> count(0);
+#else /* !NOTIFY_THREAD */
+static size_t count = 0;
+#endif /* NOTIFY_THREAD */
+
+static void exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static void event(void *arg)
+{
+    (void)arg;
+    ++count;
+}
+
+#if defined(NOTIFY_THREAD)
+static void handler(int sig)
+{
+    (void)sig;
+    timeslice_notify(timeslice + 1);
+}
+
+/* the events come from another thread and from a signal handler on it, one after each execution */
+static void notifier(void)
+{
+    for (size_t n = 0; n != step; ++n)
+    {
+        while (count != n)
+        {
+            std::this_thread::yield();
+        }
+        if (n % 2)
+        {
+            raise(SIGUSR1);
+        }
+        else
+        {
+            timeslice_notify(timeslice + 1);
+        }
+    }
+}
+#endif /* NOTIFY_THREAD */
+
+int main(int argc, char *argv[])
+{
+    size_t runs = 0;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_cron(timeslice + 0, exec, &runs, 1000);
+    timeslice_notify(timeslice + 0);
+    timeslice_exec();
+    if (runs != 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    timeslice_join(timeslice + 0);
+    timeslice_tick();
+    /* the notices before the execution coalesce, and the timer goes on */
+    timeslice_notify(timeslice + 0);
+    timeslice_notify(timeslice + 0);
+    timeslice_exec();
+    if (runs != 1 || timeslice_timer(timeslice + 0) != 999)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (size_t n = 0; n != 999; ++n)
+    {
+        timeslice_tick();
+        timeslice_exec();
+    }
+    if (runs != 2)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    timeslice_cron(timeslice + 1, event, 0, 0);
+    timeslice_join(timeslice + 1);
+    timeslice_tick();
+    count = 0;
+#if defined(NOTIFY_THREAD)
+    signal(SIGUSR1, handler);
+    std::thread thread(notifier);
+    while (count != step)
+    {
+        timeslice_exec_wait();
+    }
+    thread.join();
+#else /* !NOTIFY_THREAD */
+    for (size_t n = 0; n != step; ++n)
+    {
+        timeslice_notify(timeslice + 1);
+        timeslice_exec();
+    }
+#endif /* NOTIFY_THREAD */
+    if (count != step)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("notify %zu\n", static_cast<size_t>(count));
+
+    return status;
+}
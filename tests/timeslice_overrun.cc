@@ -0,0 +1,96 @@
+/*!
+ @file timeslice_overrun.cc
+ @brief Tesing overrun policies of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static size_t step = 0;
+static int status = 0;
+static timeslice_s timeslice[4];
+static size_t runs[4] = {0};
+static size_t seen[4] = {0};
+
+static void exec(void *arg)
+{
+    size_t i = static_cast<size_t>(static_cast<size_t *>(arg) - runs);
+    ++runs[i];
+    seen[i] += timeslice_missed(0);
+}
+
+static void check(const size_t *run, const size_t *missed, int line)
+{
+    for (size_t i = 0; i != 4; ++i)
+    {
+        if (runs[i] != run[i] || seen[i] != missed[i])
+        {
+            printf("failure in %s %i task%zu %zu %zu\n", __FILE__, line, i + 1, runs[i], seen[i]);
+            status = 1;
+        }
+        runs[i] = 0;
+        seen[i] = 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    for (size_t i = 0; i != 4; ++i)
+    {
+        timeslice_cron(timeslice + i, exec, runs + i, 10);
+        timeslice_join(timeslice + i);
+    }
+    timeslice_set_overrun(timeslice + 1, TIMESLICE_OVERRUN_CATCHUP, 1);
+    timeslice_set_overrun(timeslice + 2, TIMESLICE_OVERRUN_CATCHUP, 5);
+    timeslice_set_overrun(timeslice + 3, TIMESLICE_OVERRUN_SHIFT, 0);
+    if (timeslice_overrun(timeslice + 0) != TIMESLICE_OVERRUN_SKIP ||
+        timeslice_overrun(timeslice + 2) != TIMESLICE_OVERRUN_CATCHUP ||
+        timeslice_overrun(timeslice + 3) != TIMESLICE_OVERRUN_SHIFT)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 0; n != step; ++n)
+    {
+        for (size_t i = 0; i != 4; ++i)
+        {
+            timeslice_set_timer(timeslice + i, 10);
+        }
+        /* two whole periods pass within one advance, and the phase keeps five ticks of the third */
+        timeslice_advance(35);
+        timeslice_exec();
+        {
+            static const size_t run[4] = {1, 2, 3, 1};
+            static const size_t missed[4] = {2, 2 + 1, 2 + 1 + 0, 2};
+            check(run, missed, __LINE__);
+        }
+        if (timeslice_timer(timeslice + 0) != 5 || timeslice_timer(timeslice + 3) != 10)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+
+        /* the exec falls behind by one release */
+        for (size_t i = 0; i != 20; ++i)
+        {
+            timeslice_tick();
+        }
+        timeslice_exec();
+        {
+            static const size_t run[4] = {1, 2, 2, 1};
+            static const size_t missed[4] = {1, 1 + 0, 1 + 0, 1};
+            check(run, missed, __LINE__);
+        }
+    }
+
+    return status;
+}
@@ -0,0 +1,91 @@
+/*!
+ @file timeslice_pool.cc
+ @brief Tesing multi-core executor for timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_pool.h"
+
+#include <unistd.h>
+#include <cstdlib>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+
+#define TASKS 64
+#define WORKERS 4
+
+static int status = 0;
+static size_t step = 0;
+static std::atomic<bool> done(false);
+static std::atomic<size_t> total(0);
+static std::atomic<int> busy[TASKS];
+static timeslice_s timeslice[TASKS];
+static timeslice_sched_s sched[1];
+static timeslice_deque_s deque[WORKERS];
+static timeslice_pool_s pool[1];
+
+static void timeslice_pool_exec(void *arg)
+{
+    std::atomic<int> *p = static_cast<std::atomic<int> *>(arg);
+    if (p->fetch_add(1))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    ++total;
+    p->fetch_sub(1);
+}
+
+static void timeslice_pool_thread(size_t id)
+{
+    while (!done)
+    {
+        if (!timeslice_pool_work(pool, id))
+        {
+            std::this_thread::yield();
+        }
+    }
+    timeslice_pool_work(pool, id);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_sched_init(sched);
+    timeslice_pool_init(pool, sched, deque, WORKERS);
+    for (size_t i = 0; i != TASKS; ++i)
+    {
+        timeslice_cron(timeslice + i, timeslice_pool_exec, busy + i, i % 8 + 1);
+        timeslice_join_r(sched, timeslice + i);
+    }
+
+    std::thread thread[WORKERS];
+    for (size_t i = 0; i != WORKERS; ++i)
+    {
+        thread[i] = std::thread(timeslice_pool_thread, i);
+    }
+    for (size_t n = 0; n != step; ++n)
+    {
+        timeslice_tick_r(sched);
+        usleep(10);
+    }
+    done = true;
+    for (size_t i = 0; i != WORKERS; ++i)
+    {
+        thread[i].join();
+    }
+
+    if (timeslice_count_r(sched) != TASKS)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    printf("tick %zu exec %zu\n", step, total.load());
+
+    return status;
+}
@@ -0,0 +1,129 @@
+/*!
+ @file timeslice_prof.cc
+ @brief Tesing execution profile of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+#include "stimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static timeslice_s timeslice[2];
+static stimeslice_s stimeslice[2];
+
+static void exec(void *arg)
+{
+    volatile size_t *p = static_cast<size_t *>(arg);
+    for (size_t i = 0; i != 1000; ++i)
+    {
+        ++*p;
+    }
+}
+
+static void timeslice_dump(const timeslice_s *ctx, const timeslice_prof_s *prof, void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+    if (prof->count != step / timeslice_slice(ctx))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (prof->run_min > prof->run_max || prof->lat_min > prof->lat_max)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    printf("timeslice%zu count %llu run %llu lat %llu missed %llu\n", timeslice_slice(ctx),
+           static_cast<unsigned long long>(prof->count),
+           static_cast<unsigned long long>(timeslice_prof_run(prof)),
+           static_cast<unsigned long long>(timeslice_prof_lat(prof)),
+           static_cast<unsigned long long>(prof->missed));
+}
+
+static void stimeslice_dump(const stimeslice_s *ctx, const timeslice_prof_s *prof, void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+    if (prof->count != step / stimeslice_slice(ctx))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (prof->run_min > prof->run_max || prof->lat_min > prof->lat_max)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    printf("stimeslice%zu count %llu run %llu lat %llu missed %llu\n", stimeslice_slice(ctx),
+           static_cast<unsigned long long>(prof->count),
+           static_cast<unsigned long long>(timeslice_prof_run(prof)),
+           static_cast<unsigned long long>(timeslice_prof_lat(prof)),
+           static_cast<unsigned long long>(prof->missed));
+}
+
+int main(int argc, char *argv[])
+{
+    size_t ref = 0, count = 0;
+    timeslice_prof_s prof;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_cron(timeslice + 0, exec, &ref, 1);
+    timeslice_cron(timeslice + 1, exec, &ref, 10);
+    stimeslice_cron(stimeslice + 0, exec, &ref, 1);
+    stimeslice_cron(stimeslice + 1, exec, &ref, 10);
+    for (size_t i = 0; i != 2; ++i)
+    {
+        timeslice_join(timeslice + i);
+        stimeslice_join(stimeslice + i);
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        timeslice_tick();
+        timeslice_exec();
+        stimeslice_tick();
+        stimeslice_exec();
+    }
+    timeslice_prof_each(timeslice_dump, &count);
+    stimeslice_prof_each(stimeslice_dump, &count);
+    if (count != 4)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    /* a task that is not executed misses its periods */
+    timeslice_tick();
+    timeslice_tick();
+    timeslice_exec();
+    timeslice_prof(timeslice + 0, &prof);
+    if (prof.missed != 1)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    timeslice_advance(30);
+    timeslice_exec();
+    timeslice_prof(timeslice + 1, &prof);
+    if (prof.missed != 2)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    timeslice_prof_reset(timeslice + 0);
+    timeslice_prof(timeslice + 0, &prof);
+    if (prof.count || prof.missed || prof.run_sum)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    return status;
+}
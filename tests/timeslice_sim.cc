@@ -0,0 +1,95 @@
+/*!
+ @file timeslice_sim.cc
+ @brief Tesing virtual-time simulation driver for timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_sim.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[3] = {0};
+static timeslice_s timeslice[3];
+static timeslice_sim_task_s task[3];
+static const size_t slice[3] = {1, 10, 100};
+/* the costs in microseconds of a 1 kHz tick */
+static const uint64_t cost[3] = {100, 2000, 10000};
+
+static void exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static uint64_t timeslice_cost(const timeslice_s *ctx, void *arg)
+{
+    return static_cast<const uint64_t *>(arg)[ctx - timeslice];
+}
+
+int main(int argc, char *argv[])
+{
+    timeslice_sched_s sched[1];
+    timeslice_sim_s sim[1];
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_sched_init(sched);
+    timeslice_sim_init(sim, sched, 1000, timeslice_cost, const_cast<uint64_t *>(cost));
+    for (size_t i = 0; i != 3; ++i)
+    {
+        timeslice_cron(timeslice + i, exec, ref + i, slice[i]);
+        timeslice_sim_add(sim, task + i, timeslice + i);
+        timeslice_join_r(sched, timeslice + i);
+    }
+
+    /* the slowest task holds off the others, and the fastest one misses periods */
+    uint64_t now = timeslice_sim_run(sim, step * 1000000);
+    if (now < step * 1000000)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    /* the releases at the end are not executed yet */
+    if (ref[1] != task[1].count || task[1].count + 1 != step * 100 || task[2].count + 1 != step * 10)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    /* the periods that elapsed while executing are coalesced */
+    if (task[0].count >= step * 1000 || task[2].resp_min < cost[2])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    double util = timeslice_sim_util(sim);
+    if (util < 0.3 || util > 0.4)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    for (size_t i = 0; i != 3; ++i)
+    {
+        printf("task%zu count %llu resp %llu..%llu util %g\n", i + 1,
+               static_cast<unsigned long long>(task[i].count),
+               static_cast<unsigned long long>(task[i].resp_min),
+               static_cast<unsigned long long>(task[i].resp_max), timeslice_sim_task_util(task + i));
+        timeslice_sim_del(task + i);
+    }
+    printf("util %g\n", util);
+
+    /* nothing is armed, so the time jumps to the end */
+    timeslice_drop_r(sched, timeslice + 0);
+    timeslice_drop_r(sched, timeslice + 1);
+    timeslice_drop_r(sched, timeslice + 2);
+    if (timeslice_sim_run(sim, 1000000000) < now + 1000000000)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    return status;
+}
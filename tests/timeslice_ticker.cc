@@ -0,0 +1,87 @@
+/*!
+ @file timeslice_ticker.cc
+ @brief Tesing Linux tick source for timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_ticker.h"
+
+#include <unistd.h>
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[2] = {0};
+static timeslice_s timeslice[2];
+static timeslice_sched_s sched[1];
+static timeslice_ticker_s ticker[1];
+
+static void timeslice_ticker_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static void timeslice_ticker_show(int mode)
+{
+    timeslice_ticker_stat_s stat;
+    timeslice_sched_init(sched);
+    timeslice_cron(timeslice + 0, timeslice_ticker_exec, ref + 0, 1);
+    timeslice_cron(timeslice + 1, timeslice_ticker_exec, ref + 1, 10);
+    timeslice_join_r(sched, timeslice + 0);
+    timeslice_join_r(sched, timeslice + 1);
+    ref[0] = ref[1] = 0;
+
+    if (timeslice_ticker_start(ticker, sched, 100000, mode, 0))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+        return;
+    }
+    while (ref[0] < step)
+    {
+        timeslice_exec_wait_r(sched);
+    }
+    timeslice_ticker_stop(ticker);
+    timeslice_ticker_stat(ticker, &stat);
+
+    if (stat.ticks < step || ref[1] < step / 10 - 1 || stat.jitter_min > stat.jitter_max ||
+        stat.overruns != stat.ticks - stat.wakeups)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    printf("mode %i ticks %llu overruns %llu jitter min %llu max %llu mean %llu ns\n", mode,
+           static_cast<unsigned long long>(stat.ticks),
+           static_cast<unsigned long long>(stat.overruns),
+           static_cast<unsigned long long>(stat.jitter_min),
+           static_cast<unsigned long long>(stat.jitter_max),
+           static_cast<unsigned long long>(stat.jitter_sum / (stat.wakeups ? stat.wakeups : 1)));
+}
+
+static void timeslice_ticker_fail(void)
+{
+    timeslice_ticker_s idle[1] = {};
+    /* a ticker that was never started, or failed to start, may still be stopped */
+    timeslice_ticker_stop(idle);
+    if (timeslice_ticker_start(idle, sched, 100000, TIMESLICE_TICKER_NANOSLEEP, CPU_SETSIZE - 1) == 0)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    timeslice_ticker_stop(idle);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_ticker_show(TIMESLICE_TICKER_NANOSLEEP);
+    timeslice_ticker_show(TIMESLICE_TICKER_TIMERFD);
+    timeslice_ticker_fail();
+
+    return status;
+}
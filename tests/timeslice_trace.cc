@@ -0,0 +1,92 @@
+/*!
+ @file timeslice_trace.cc
+ @brief Tesing binary trace of cooperative scheduler timeslice.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static timeslice_s timeslice[2];
+static timeslice_trace_rec_s ring[1 << 12];
+static timeslice_trace_rec_s rec[1 << 12];
+static timeslice_trace_s trace[1];
+
+static void exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t ref = 0, count[TIMESLICE_TRACE_DROP + 1] = {0};
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    timeslice_trace_init(trace, ring, sizeof(ring) / sizeof(*ring));
+    timeslice_trace_attach(trace);
+    timeslice_cron(timeslice + 0, exec, &ref, 1);
+    timeslice_cron(timeslice + 1, exec, &ref, 10);
+    timeslice_join(timeslice + 0);
+    timeslice_join(timeslice + 1);
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        timeslice_tick();
+        timeslice_exec();
+    }
+    timeslice_drop(timeslice + 1);
+
+    size_t size = timeslice_trace_read(trace, rec, sizeof(rec) / sizeof(*rec));
+    if (size != (step < 1000 ? 3 + step * 4 + step / 10 * 3 : sizeof(rec) / sizeof(*rec)))
+    {
+        printf("failure in %s %i %zu\n", __FILE__, __LINE__, size);
+        status = 1;
+    }
+    for (size_t i = 0; i != size; ++i)
+    {
+        if (i && rec[i].time < rec[i - 1].time)
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        if (rec[i].event == TIMESLICE_TRACE_END &&
+            (i == 0 || rec[i - 1].event != TIMESLICE_TRACE_START || rec[i - 1].task != rec[i].task))
+        {
+            printf("failure in %s %i\n", __FILE__, __LINE__);
+            status = 1;
+        }
+        ++count[rec[i].event];
+    }
+    if (rec[size - 1].event != TIMESLICE_TRACE_DROP)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (count[TIMESLICE_TRACE_START] != count[TIMESLICE_TRACE_DUE])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    if (argc > 2)
+    {
+        FILE *out = fopen(argv[2], "wb");
+        if (out)
+        {
+            fwrite(rec, sizeof(*rec), size, out);
+            fclose(out);
+        }
+    }
+
+    printf("tick %zu due %zu exec %zu ref %zu\n", count[TIMESLICE_TRACE_TICK], count[TIMESLICE_TRACE_DUE],
+           count[TIMESLICE_TRACE_START], ref);
+
+    return status;
+}
@@ -0,0 +1,159 @@
+/*!
+ @file vtimeslice.cc
+ @brief Tesing cooperative scheduler timeslice with a structure-of-arrays timer table.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "vtimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[5] = {0};
+static vtimeslice_sched_s sched[1];
+static void *memory[VTIMESLICE_MEMORY(200) / sizeof(void *)];
+static size_t crowd[200];
+static const size_t slice[5] = {10, 63, 64, 4097, 60000};
+
+static void vtimeslice1_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 0;
+    if (++*p % 2 == 0)
+    {
+        vtimeslice_drop_r(sched, 0);
+        vtimeslice_drop_r(sched, 0);
+    }
+}
+
+static void vtimeslice2_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 1;
+    if (++*p % 2 == 0)
+    {
+        vtimeslice_join_r(sched, 0);
+        vtimeslice_join_r(sched, 0);
+    }
+}
+
+static void vtimeslice3_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 2);
+}
+
+static void vtimeslice4_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 3);
+}
+
+static void vtimeslice5_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 4);
+}
+
+static void vtimeslice7_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+}
+
+static void vtimeslice6_exec(void *arg)
+{
+    ++*static_cast<size_t *>(arg);
+    if (vtimeslice_self_r(sched) != 5)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    size_t once = 0;
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    vtimeslice_sched_init(sched, memory, 200);
+    vtimeslice_cron_r(sched, 0, vtimeslice1_exec, ref, slice[0]);
+    vtimeslice_cron_r(sched, 1, vtimeslice2_exec, ref, slice[1]);
+    vtimeslice_cron_r(sched, 2, vtimeslice3_exec, ref, slice[2]);
+    vtimeslice_cron_r(sched, 3, vtimeslice4_exec, ref, slice[3]);
+    vtimeslice_cron_r(sched, 4, vtimeslice5_exec, ref, slice[4]);
+    vtimeslice_once_r(sched, 5, vtimeslice6_exec, &once, 100);
+    for (size_t i = 0; i != 6; ++i)
+    {
+        vtimeslice_join_r(sched, i);
+    }
+    /* the crowd spans the lanes of several words with every phase of its slices */
+    for (size_t i = 8; i != 200; ++i)
+    {
+        vtimeslice_cron_r(sched, i, vtimeslice7_exec, crowd + i, i % 13 + 1);
+        vtimeslice_set_timer_r(sched, i, i % 7 + 1);
+        vtimeslice_join_r(sched, i);
+    }
+    if (vtimeslice_count_r(sched) != 6 + 192)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        vtimeslice_tick_r(sched);
+        vtimeslice_exec_r(sched);
+    }
+
+    for (size_t i = 1; i != 5; ++i)
+    {
+        if (ref[i] != step / slice[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, ref[i]);
+            status = 1;
+        }
+    }
+    if (once != (step >= 100) || vtimeslice_exist_r(sched, 5) != (step < 100))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (vtimeslice_timer_r(sched, 4) != slice[4] - step % slice[4])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t i = 8; i != 200; ++i)
+    {
+        size_t timer = i % 7 + 1, period = i % 13 + 1;
+        size_t count = step < timer ? 0 : (step - timer) / period + 1;
+        if (crowd[i] != count)
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, crowd[i]);
+            status = 1;
+        }
+        vtimeslice_drop_r(sched, i);
+    }
+
+    vtimeslice_drop_r(sched, 4);
+    if (vtimeslice_exist_r(sched, 4))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (vtimeslice_count_r(sched) !=
+        3U + static_cast<size_t>(vtimeslice_exist_r(sched, 0)) + static_cast<size_t>(vtimeslice_exist_r(sched, 5)))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("task1 %zu\n", ref[0]);
+    printf("task2 %zu\n", ref[1]);
+    printf("task3 %zu\n", ref[2]);
+    printf("task4 %zu\n", ref[3]);
+    printf("task5 %zu\n", ref[4]);
+
+    return status;
+}
@@ -0,0 +1,115 @@
+/*!
+ @file wtimeslice.cc
+ @brief Tesing cooperative scheduler timeslice based on timing wheel.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "wtimeslice.h"
+
+#include <cstdlib>
+#include <cstdio>
+
+static int status = 0;
+static size_t step = 0;
+static size_t ref[5] = {0};
+static wtimeslice_s wtimeslice[5];
+static const size_t slice[5] = {10, 63, 64, 4097, 300000};
+
+static void wtimeslice1_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 0;
+    if (++*p % 2 == 0)
+    {
+        wtimeslice_drop(wtimeslice + 0);
+        wtimeslice_drop(wtimeslice + 0);
+    }
+}
+
+static void wtimeslice2_exec(void *arg)
+{
+    size_t *p = static_cast<size_t *>(arg) + 1;
+    if (++*p % 2 == 0)
+    {
+        wtimeslice_join(wtimeslice + 0);
+        wtimeslice_join(wtimeslice + 0);
+    }
+}
+
+static void wtimeslice3_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 2);
+}
+
+static void wtimeslice4_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 3);
+}
+
+static void wtimeslice5_exec(void *arg)
+{
+    ++*(static_cast<size_t *>(arg) + 4);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        step = static_cast<size_t>(atoi(argv[1]));
+    }
+
+    wtimeslice_cron(wtimeslice + 0, wtimeslice1_exec, ref, slice[0]);
+    wtimeslice_cron(wtimeslice + 1, wtimeslice2_exec, ref, slice[1]);
+    wtimeslice_cron(wtimeslice + 2, wtimeslice3_exec, ref, slice[2]);
+    wtimeslice_cron(wtimeslice + 3, wtimeslice4_exec, ref, slice[3]);
+    wtimeslice_cron(wtimeslice + 4, wtimeslice5_exec, ref, slice[4]);
+    wtimeslice_join(wtimeslice + 0);
+    wtimeslice_join(wtimeslice + 1);
+    wtimeslice_join(wtimeslice + 2);
+    wtimeslice_join(wtimeslice + 3);
+    wtimeslice_join(wtimeslice + 4);
+    if (wtimeslice_count() != 5)
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    for (size_t n = 1; n <= step; ++n)
+    {
+        wtimeslice_tick();
+        wtimeslice_exec();
+    }
+
+    for (size_t i = 1; i != 5; ++i)
+    {
+        if (ref[i] != step / slice[i])
+        {
+            printf("failure in %s %i task%zu %zu\n", __FILE__, __LINE__, i + 1, ref[i]);
+            status = 1;
+        }
+    }
+    if (wtimeslice_timer(wtimeslice + 4) != slice[4] - step % slice[4])
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    wtimeslice_drop(wtimeslice + 4);
+    if (wtimeslice_exist(wtimeslice + 4))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+    if (wtimeslice_count() != (wtimeslice_exist(wtimeslice + 0) ? 4U : 3U))
+    {
+        printf("failure in %s %i\n", __FILE__, __LINE__);
+        status = 1;
+    }
+
+    printf("task1 %zu\n", ref[0]);
+    printf("task2 %zu\n", ref[1]);
+    printf("task3 %zu\n", ref[2]);
+    printf("task4 %zu\n", ref[3]);
+    printf("task5 %zu\n", ref[4]);
+
+    return status;
+}
@@ -0,0 +1,69 @@
+/*!
+ @file timeslice_trace2json.c
+ @brief Convert the records of timeslice trace to the trace event JSON of Chrome.
+ @details The input is the array of timeslice_trace_rec_s read by timeslice_trace_read().
+ The output can be opened by chrome://tracing or https://ui.perfetto.dev, where every task
+ is a thread, the executions are slices and the other events are instants.
+ @copyright Copyright (C) 2020 tqfx, All rights reserved.
+*/
+
+#include "timeslice_trace.h"
+
+#include <stdio.h>
+
+static const char *const name[] = {"tick", "due", "exec", "exec", "join", "drop"};
+
+int main(int argc, char *argv[])
+{
+    FILE *in = stdin, *out = stdout;
+    timeslice_trace_rec_s rec;
+    const char *sep = "";
+    if (argc > 1 && (in = fopen(argv[1], "rb")) == 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+    if (argc > 2 && (out = fopen(argv[2], "w")) == 0)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    while (fread(&rec, sizeof(rec), 1, in) == 1)
+    {
+        unsigned long long us = (unsigned long long)(rec.time / 1000);
+        unsigned int ns = (unsigned int)(rec.time % 1000);
+        if (rec.event > TIMESLICE_TRACE_DROP)
+        {
+            continue;
+        }
+        fprintf(out, "%s\n{\"name\":\"%s\",\"pid\":1,\"tid\":%lu,\"ts\":%llu.%03u,", sep,
+                name[rec.event], (unsigned long)rec.task, us, ns);
+        switch (rec.event)
+        {
+        case TIMESLICE_TRACE_START:
+            fprintf(out, "\"ph\":\"B\"}");
+            break;
+        case TIMESLICE_TRACE_END:
+            fprintf(out, "\"ph\":\"E\"}");
+            break;
+        case TIMESLICE_TRACE_TICK:
+            fprintf(out, "\"ph\":\"i\",\"s\":\"g\",\"args\":{\"elapsed\":%u}}", rec.arg);
+            break;
+        default:
+            fprintf(out, "\"ph\":\"i\",\"s\":\"t\",\"args\":{\"arg\":%u}}", rec.arg);
+            break;
+        }
+        sep = ",";
+    }
+    fprintf(out, "\n]}\n");
+    if (in != stdin)
+    {
+        fclose(in);
+    }
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    return 0;
+}